@@ -4,6 +4,7 @@
 #include "classes/Checkers.h"
 #include "classes/Othello.h"
 #include "classes/Chess.h"
+#include "classes/KInARow.h"
 
 namespace ClassGame {
         //
@@ -38,6 +39,7 @@ namespace ClassGame {
                     ImGui::Text("Game Over!");
                     ImGui::Text("Winner: %d", gameWinner);
                     if (ImGui::Button("Reset Game")) {
+                        game->cancelAI();
                         game->stopGame();
                         game->setUpBoard();
                         gameOver = false;
@@ -61,8 +63,15 @@ namespace ClassGame {
                         game = new Chess();
                         game->setUpBoard();
                     }
+                    if (ImGui::Button("Start Gomoku")) {
+                        game = new KInARow(15, 15, 5);
+                        game->setUpBoard();
+                    }
                 } else {
                     ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
+                    if (game->isAIThinking()) {
+                        ImGui::Text("AI thinking...");
+                    }
                     std::string stateString = game->stateString();
                     int stride = game->_gameOptions.rowX;
                     int height = game->_gameOptions.rowY;
@@ -76,9 +85,10 @@ namespace ClassGame {
 
                 ImGui::Begin("GameWindow");
                 if (game) {
-                    if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
+                    // the search runs on a worker thread, this only starts it or collects its move
+                    if (!gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
                     {
-                        game->updateAI();
+                        game->updateAIAsync();
                     }
                     game->drawFrame();
                 }
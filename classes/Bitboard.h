@@ -4,6 +4,10 @@
 #include <intrin.h>
 #endif
 #include <iostream>
+#include <cstdint>
+
+constexpr int WHITE = 0;
+constexpr int BLACK = 1;
 
 enum ChessPiece
 {
@@ -16,6 +20,59 @@ enum ChessPiece
     King
 };
 
+// bitboard indices; the twelve piece boards double as piece codes (color * 6 + piece - 1)
+enum AllBitBoards {
+    W_PAWNS,
+    W_KNIGHTS,
+    W_BISHOPS,
+    W_ROOKS,
+    W_QUEENS,
+    W_KING,
+    B_PAWNS,
+    B_KNIGHTS,
+    B_BISHOPS,
+    B_ROOKS,
+    B_QUEENS,
+    B_KING,
+    W_ALL,
+    B_ALL,
+    OCCUPANCY,
+    EMPTY_SQUARES,
+    e_numBitboards
+};
+
+inline int bitScanForward(uint64_t bb) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return index;
+#else
+    return __builtin_ctzll(bb);
+#endif
+}
+
+inline int popCount(uint64_t bb) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (int)__popcnt64(bb);
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
+// returns the lowest set square and clears it
+inline int popLSB(uint64_t &bb) {
+    int square = bitScanForward(bb);
+    bb &= bb - 1;
+    return square;
+}
+
+// 32 square boards (checkers)
+inline int popLSB(uint32_t &bb) {
+    int square = bitScanForward(bb);
+    bb &= bb - 1;
+    return square;
+}
+
 class BitboardElement {
   public:
     // Constructors
@@ -79,19 +136,44 @@ private:
 
 };
 
+// the 4 bit move type. bit 2 marks captures and bit 3 promotions, the low
+// two bits of a promotion pick the piece
+enum MoveFlags {
+    MoveNormal = 0,
+    MoveDoublePush = 1,
+    MoveCastle = 2,
+    MoveCapture = 4,
+    MoveEnPassant = 5,
+    MovePromoteKnight = 8,
+    MovePromoteBishop = 9,
+    MovePromoteRook = 10,
+    MovePromoteQueen = 11
+};
+
+// a move packed in 16 bits: from in bits 0-5, to in 6-11, flags in 12-15.
+// the same value is what the transposition table stores
 struct BitMove {
-    uint8_t from;
-    uint8_t to;
-    uint8_t piece;
-    
-    BitMove(int from, int to, ChessPiece piece)
-        : from(from), to(to), piece(piece) { }
-        
-    BitMove() : from(0), to(0), piece(NoPiece) { }
-    
-    bool operator==(const BitMove& other) const {
-        return from == other.from && 
-               to == other.to && 
-               piece == other.piece;
-    }
-};
\ No newline at end of file
+    BitMove() : _data(0) { }
+    BitMove(int from, int to, int flags = MoveNormal)
+        : _data((uint16_t)(from | to << 6 | flags << 12)) { }
+    explicit BitMove(uint16_t data) : _data(data) { }
+
+    int from() const { return _data & 63; }
+    int to() const { return (_data >> 6) & 63; }
+    int flags() const { return _data >> 12; }
+    uint16_t raw() const { return _data; }
+
+    // the default move, what a search with no legal moves returns
+    bool isNull() const { return _data == 0; }
+    bool isCapture() const { return _data & (MoveCapture << 12); }
+    bool isPromotion() const { return _data & (MovePromoteKnight << 12); }
+    ChessPiece promotionPiece() const { return (ChessPiece)(Knight + (flags() & 3)); }
+
+    bool operator==(const BitMove& other) const { return _data == other._data; }
+    bool operator!=(const BitMove& other) const { return _data != other._data; }
+
+private:
+    uint16_t _data;
+};
+
+static_assert(sizeof(BitMove) == 2, "moves are packed in 16 bits");
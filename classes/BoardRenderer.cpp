@@ -0,0 +1,35 @@
+#include "BoardRenderer.h"
+#include <algorithm>
+
+void BoardRenderer::draw(Grid &grid)
+{
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetWindowPos();
+    origin.x -= ImGui::GetScrollX();
+    origin.y -= ImGui::GetScrollY();
+    ImVec2 extent(0, 0);
+
+    _splitter.Split(drawList, LayerCount);
+    grid.forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+        _splitter.SetCurrentChannel(drawList, LayerSquares);
+        square->paintSprite(drawList, origin);
+        extent.x = std::max(extent.x, square->getPosition().x + square->getSize().x);
+        extent.y = std::max(extent.y, square->getPosition().y + square->getSize().y);
+
+        Bit* bit = square->bit();
+        if (!bit) {
+            return;
+        }
+        Layer layer = bit->getPickedUp() ? LayerPickedUp : bit->getMoving() ? LayerMoving : LayerPieces;
+        if (layer == LayerMoving) {
+            bit->update();
+        }
+        _splitter.SetCurrentChannel(drawList, layer);
+        bit->paintSprite(drawList, origin);
+    });
+    _splitter.Merge(drawList);
+
+    // the quads aren't items, claim their area so the window scrolls over it
+    ImGui::SetCursorPos(ImVec2(0, 0));
+    ImGui::Dummy(extent);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Grid.h"
+
+//
+// draws a grid and its pieces into the window's draw list in one pass
+// each sprite is a textured quad put straight into the list, sorted into
+// layers by a draw list splitter: squares, resting pieces, moving pieces and
+// the piece being dragged on top. with the art in one atlas the merged layers
+// come out as a handful of draw calls however many pieces there are
+//
+
+class BoardRenderer
+{
+public:
+    enum Layer {
+        LayerSquares,
+        LayerPieces,
+        LayerMoving,
+        LayerPickedUp,
+        LayerCount
+    };
+
+    // sprite positions are window-local, like ImGui::SetCursorPos
+    void draw(Grid &grid);
+
+private:
+    // kept between frames so its channels' buffers are reused
+    ImDrawListSplitter _splitter;
+};
@@ -1,14 +1,31 @@
 #include "Checkers.h"
+#include <algorithm>
+#include <iterator>
 
-Checkers::Checkers() : Game() {
+namespace {
+
+bool sameMove(const CheckersMove &a, const CheckersMove &b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+int moveIndex(const std::vector<CheckersMove> &moves, const CheckersMove &move) {
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (sameMove(moves[i], move)) return (int)i;
+    }
+    return -1;
+}
+
+}
+
+Checkers::Checkers() : Game(), _tt(16), _search(_tt), _bestSoFar(-1) {
     _grid = new Grid(8, 8);
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
+    _chainFrom = -1;
+    _chainSquare = -1;
+    _chainCaptured = 0;
 }
 
 Checkers::~Checkers() {
+    cancelAI();
     delete _grid;
 }
 
@@ -20,24 +37,21 @@ void Checkers::setUpBoard() {
     // Initialize all squares
     _grid->initializeSquares(80, "boardsquare.png");
 
-    // Enable only dark squares and place pieces
+    // Enable only dark squares
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        bool isDark = (x + y) % 2 == 1;
-        _grid->setEnabled(x, y, isDark);
-
-        if (isDark) {
-            if (y < 3) {
-                Bit* piece = createPiece(RED_PIECE);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            } else if (y > 4) {
-                Bit* piece = createPiece(YELLOW_PIECE);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            }
-        }
+        _grid->setEnabled(x, y, (x + y) % 2 == 1);
     });
 
+    _board.reset();
+    syncBoardToGrid();
+    generateMoves();
+    _chainFrom = -1;
+    _tt.clear();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
     startGame();
 }
 
@@ -52,243 +66,235 @@ Bit* Checkers::createPiece(int pieceType) {
     return bit;
 }
 
+void Checkers::syncBoardToGrid() {
+    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+        int index = CheckersBoard::squareAt(x, y);
+        if ((~_board.empty() >> index) & 1) {
+            Bit* piece = createPiece(_board.pieceIndex(index) + 1);
+            piece->setPosition(square->getPosition());
+            square->setBit(piece);
+        }
+    });
+}
+
+int Checkers::squareIndex(BitHolder &holder) const {
+    ChessSquare* square = static_cast<ChessSquare*>(&holder);
+    return CheckersBoard::squareAt(square->getColumn(), square->getRow());
+}
+
 bool Checkers::actionForEmptyHolder(BitHolder &holder) {
     return false; // Checkers doesn't place new pieces
 }
 
 bool Checkers::canBitMoveFrom(Bit &bit, BitHolder &src) {
     if (!src.bit() || bit.getOwner() != getCurrentPlayer()) return false;
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
 
-    ChessSquare* square = static_cast<ChessSquare*>(&src);
-    int x = square->getColumn();
-    int y = square->getRow();
+    int square = squareIndex(src);
+    if (square < 0) return false;
+    if (_chainFrom >= 0) return square == _chainSquare;
 
-    // Must jump if available
-    if (hasJumpAvailable(bit.getOwner())) {
-        return canJumpFrom(*square);
-    }
-    return true;
+    // Must jump if available, the targets only hold captures then
+    return _targets[square] != 0;
 }
 
 bool Checkers::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
     if (!src.bit() || dst.bit()) return false;
 
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-
-    if (!_grid->isEnabled(dstSquare->getColumn(), dstSquare->getRow())) return false;
+    int from = squareIndex(src);
+    int to = squareIndex(dst);
+    if (from < 0 || to < 0) return false;
 
-    bool isKing = (bit.gameTag() == RED_KING || bit.gameTag() == YELLOW_KING);
-    bool isRed = (bit.getOwner() == getPlayerAt(RED_PLAYER));
-
-    // Simple moves (if no jumps required)
-    if (!_mustContinueJumping && !hasJumpAvailable(bit.getOwner())) {
-        if (isKing) {
-            return dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY) ||
-                   dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY);
-        }
-        return isRed ? (dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY)) :
-                       (dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY));
+    // Jump moves are dragged one hop at a time
+    if (_chainFrom >= 0) {
+        return from == _chainSquare && ((_board.hopTargets(_chainFrom, from, _chainCaptured) >> to) & 1);
     }
 
-    // Jump moves
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
+    return (_targets[from] >> to) & 1;
+}
 
-    // Check all jump directions
-    auto checkJump = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        if (!middle || !target || !middle->bit()) return false;
-        if (middle->bit()->getOwner() == bit.getOwner()) return false;
-        return dstSquare == target;
-    };
+// the legal moves, and where each square's piece may be dropped first. a capture
+// chain is dragged one hop at a time so its first landing squares are the targets
+void Checkers::generateMoves() {
+    CheckersMove moves[CheckersBoard::maxMoves];
+    _moves.assign(moves, moves + _board.generateMoves(moves));
 
-    if (isKing || !isRed) {
-        if (checkJump(_grid->getFL(srcX, srcY), _grid->getFLFL(srcX, srcY))) return true;
-        if (checkJump(_grid->getFR(srcX, srcY), _grid->getFRFR(srcX, srcY))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJump(_grid->getBL(srcX, srcY), _grid->getBLBL(srcX, srcY))) return true;
-        if (checkJump(_grid->getBR(srcX, srcY), _grid->getBRBR(srcX, srcY))) return true;
+    std::fill(std::begin(_targets), std::end(_targets), 0u);
+    for (const CheckersMove &move : _moves) {
+        _targets[move.from] |= move.captured ? _board.hopTargets(move.from, move.from, 0) : 1u << move.to;
     }
-
-    return false;
 }
 
 void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-    int dstX = dstSquare->getColumn();
-    int dstY = dstSquare->getRow();
-
-    // Check for jump
-    ChessSquare* jumped = nullptr;
-    if (dstSquare == _grid->getFLFL(srcX, srcY)) jumped = _grid->getFL(srcX, srcY);
-    else if (dstSquare == _grid->getFRFR(srcX, srcY)) jumped = _grid->getFR(srcX, srcY);
-    else if (dstSquare == _grid->getBLBL(srcX, srcY)) jumped = _grid->getBL(srcX, srcY);
-    else if (dstSquare == _grid->getBRBR(srcX, srcY)) jumped = _grid->getBR(srcX, srcY);
-
-    if (jumped && jumped->bit()) {
-        // Capture
-        (jumped->bit()->getOwner() == getPlayerAt(RED_PLAYER)) ? _redPieces-- : _yellowPieces--;
-        jumped->destroyBit();
-
-        // Promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
+    int from = squareIndex(src);
+    int to = squareIndex(dst);
+
+    int jumped = CheckersBoard::jumpedSquare(from, to);
+    if (jumped < 0) {
+        // Regular move
+        CheckersMove move;
+        move.from = (uint8_t)from;
+        move.to = (uint8_t)to;
+        finishMove(move, bit);
+        return;
+    }
 
-        // Check for more jumps
-        if (canJumpFrom(*dstSquare)) {
-            _mustContinueJumping = true;
-            _jumpingPiece = &dst;
-            return;
-        }
-    } else {
-        // Regular move - promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
+    // Capture
+    if (_chainFrom < 0) {
+        _chainFrom = from;
+        _chainCaptured = 0;
+    }
+    _chainSquare = to;
+    _chainCaptured |= 1u << jumped;
+    _grid->getSquare(CheckersBoard::squareX(jumped), CheckersBoard::squareY(jumped))->destroyBit();
+
+    // Check for more jumps, a man that reaches the far row stops there
+    bool crowned = !_board.isKing(_chainFrom) && ((CheckersBoard::crownRow(_board.sideToMove()) >> to) & 1);
+    if (!crowned && _board.hopTargets(_chainFrom, to, _chainCaptured)) {
+        return;
     }
 
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    endTurn();
+    CheckersMove move;
+    move.from = (uint8_t)_chainFrom;
+    move.to = (uint8_t)to;
+    move.captured = _chainCaptured;
+    _chainFrom = -1;
+    finishMove(move, bit);
 }
 
-bool Checkers::canJumpFrom(ChessSquare& square) const {
-    Bit* piece = square.bit();
-    if (!piece) return false;
-
-    int x = square.getColumn();
-    int y = square.getRow();
-    bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-    bool isRed = (piece->getOwner() == getPlayerAt(RED_PLAYER));
-    Player* player = piece->getOwner();
-
-    auto checkJumpDir = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        return middle && middle->bit() && middle->bit()->getOwner() != player &&
-               target && !target->bit();
-    };
+void Checkers::finishMove(const CheckersMove &move, Bit &bit) {
+    _board.play(move);
 
-    if (isKing || !isRed) {
-        if (checkJumpDir(_grid->getFL(x, y), _grid->getFLFL(x, y))) return true;
-        if (checkJumpDir(_grid->getFR(x, y), _grid->getFRFR(x, y))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJumpDir(_grid->getBL(x, y), _grid->getBLBL(x, y))) return true;
-        if (checkJumpDir(_grid->getBR(x, y), _grid->getBRBR(x, y))) return true;
+    // Promotion check
+    if (_board.isKing(move.to) && (bit.gameTag() == RED_PIECE || bit.gameTag() == YELLOW_PIECE)) {
+        bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
+        bit.setScale(1.3f);
     }
-    return false;
-}
 
-bool Checkers::hasJumpAvailable(Player* player) const {
-    bool hasJump = false;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasJump) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == player) {
-            Checkers* self = const_cast<Checkers*>(this);
-            if (self->canJumpFrom(*square)) {
-                hasJump = true;
-            }
-        }
-    });
-    return hasJump;
+    generateMoves();
+    endTurn();
 }
 
 Player* Checkers::checkForWinner() {
-    if (_redPieces == 0) return getPlayerAt(YELLOW_PLAYER);
-    if (_yellowPieces == 0) return getPlayerAt(RED_PLAYER);
-
-    // Check if current player has any moves
-    Player* current = getCurrentPlayer();
-    bool hasMove = false;
-
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasMove) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == current) {
-            bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-            bool isRed = (current == getPlayerAt(RED_PLAYER));
-
-            // Check for any valid move
-            auto checkMove = [&](ChessSquare* target) {
-                if (target && !target->bit()) hasMove = true;
-            };
-
-            if (isKing) {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else if (isRed) {
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-            }
-        }
-    });
-
-    if (!hasMove) {
-        return current == getPlayerAt(RED_PLAYER) ? getPlayerAt(YELLOW_PLAYER) : getPlayerAt(RED_PLAYER);
+    // the side to move loses when it has no pieces or no moves left
+    if (_moves.empty()) {
+        return getPlayerAt(_board.sideToMove() ^ 1);
     }
     return nullptr;
 }
 
 bool Checkers::checkForDraw() {
-    return false;
+    return _board.isDraw();
 }
 
 void Checkers::stopGame() {
+    cancelAI();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
+    _board.reset();
+    _moves.clear();
+    std::fill(std::begin(_targets), std::end(_targets), 0u);
+    _chainFrom = -1;
 }
 
 std::string Checkers::initialStateString() {
-    return "111111111111--------333333333333";
+    return "11111111111100000000333333333333";
 }
 
 std::string Checkers::stateString() {
-    return _grid->getStateString();
+    std::string state(32, '0');
+    for (int square = 0; square < 32; square++) {
+        if ((~_board.empty() >> square) & 1) {
+            state[square] = (char)('1' + _board.pieceIndex(square));
+        }
+    }
+    return state;
 }
 
 void Checkers::setStateString(const std::string &s) {
     if (s.length() != 32) return;
+    loadState(s, _board.sideToMove(), 0);
+}
 
-    _redPieces = 0;
-    _yellowPieces = 0;
+std::string Checkers::historyState() {
+    int quietPlies = std::min(_board.quietPlies(), 99);
+    std::string state = stateString();
+    state += (char)('0' + _board.sideToMove());
+    state += (char)('0' + quietPlies / 10);
+    state += (char)('0' + quietPlies % 10);
+    return state;
+}
 
-    _grid->setStateString(s);
+void Checkers::setHistoryState(const std::string &s) {
+    if (s.length() != 35) return;
+    loadState(s.substr(0, 32), s[32] == '1' ? YELLOW_PLAYER : RED_PLAYER, (s[33] - '0') * 10 + (s[34] - '0'));
+}
 
-    // Recreate pieces from state
-    size_t index = 0;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            int pieceType = s[index++] - '0';
-            if (pieceType != 0) {
-                Bit* piece = createPiece(pieceType);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-                (pieceType == RED_PIECE || pieceType == RED_KING) ? _redPieces++ : _yellowPieces++;
+void Checkers::loadState(const std::string &s, int sideToMove, int quietPlies) {
+    uint32_t pieces[2] = { 0, 0 };
+    uint32_t kings = 0;
+    for (int square = 0; square < 32; square++) {
+        int pieceType = s[square] - '0';
+        if (pieceType >= RED_PIECE && pieceType <= YELLOW_KING) {
+            pieces[pieceType >= YELLOW_PIECE ? YELLOW_PLAYER : RED_PLAYER] |= 1u << square;
+            if (pieceType == RED_KING || pieceType == YELLOW_KING) {
+                kings |= 1u << square;
             }
         }
+    }
+    _board.set(pieces[RED_PLAYER], pieces[YELLOW_PLAYER], kings, sideToMove, quietPlies);
+    syncBoardToGrid();
+
+    generateMoves();
+    _chainFrom = -1;
+}
+
+uint64_t Checkers::zobristKey() {
+    return _board.hash();
+}
+
+void Checkers::updateAI() {
+    std::function<int()> job = makeAISearch();
+    if (job) {
+        applyAIMove(job());
+    }
+}
+
+std::function<int()> Checkers::makeAISearch() {
+    if (_moves.empty() || _chainFrom >= 0) {
+        return nullptr;
+    }
+
+    CheckersSearchLimits limits;
+    aiSearchBudget(limits.maxDepth, limits.moveTimeMs);
+    _bestSoFar.store(-1, std::memory_order_relaxed);
+    _search.setIterationCallback([this, moves = _moves](const CheckersSearchResult &result) {
+        _bestSoFar.store(moveIndex(moves, result.move), std::memory_order_relaxed);
     });
+
+    return [this, board = _board, moves = _moves, limits]() {
+        return moveIndex(moves, _search.search(board, limits).move);
+    };
 }
 
-void Checkers::updateAI() {}
+void Checkers::applyAIMove(int move) {
+    if (move < 0 || move >= (int)_moves.size()) return;
 
+    CheckersMove played = _moves[move];
+    ChessSquare* src = _grid->getSquare(CheckersBoard::squareX(played.from), CheckersBoard::squareY(played.from));
+    ChessSquare* dst = _grid->getSquare(CheckersBoard::squareX(played.to), CheckersBoard::squareY(played.to));
+    Bit* bit = src->bit();
+    if (!bit) return;
+
+    // a king's chain can end where it started
+    if (src != dst) {
+        if (!dst->dropBitAtPoint(bit, dst->getPosition())) return;
+        src->draggedBitTo(bit, dst);
+    }
+    for (uint32_t captured = played.captured; captured;) {
+        int square = popLSB(captured);
+        _grid->getSquare(CheckersBoard::squareX(square), CheckersBoard::squareY(square))->destroyBit();
+    }
+    finishMove(played, *bit);
+}
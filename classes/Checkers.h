@@ -1,5 +1,7 @@
 #pragma once
 #include "Game.h"
+#include "CheckersSearch.h"
+#include <vector>
 
 // NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
 // add a method like setColor(ImVec4 color) to Square class
@@ -17,6 +19,10 @@ public:
     std::string initialStateString() override;
     std::string stateString() override;
     void        setStateString(const std::string &s) override;
+    // the state string, then the side to move and two digits of quiet plies
+    std::string historyState() override;
+    void        setHistoryState(const std::string &s) override;
+    uint64_t    zobristKey() override;
     bool        actionForEmptyHolder(BitHolder &holder) override;
     bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
@@ -25,9 +31,16 @@ public:
 
     // AI methods
     void        updateAI() override;
-    bool        gameHasAI() override { return false; } // Set to true when AI is implemented
+    bool        gameHasAI() override { return true; } // Set to true when AI is implemented
+    int         bestAIMoveSoFar() override { return _bestSoFar.load(std::memory_order_relaxed); }
     Grid* getGrid() override { return _grid; }
 
+protected:
+    // AI moves are indices into the legal move list
+    std::function<int()> makeAISearch() override;
+    void        applyAIMove(int move) override;
+    void        stopAISearch() override { _search.stop(); }
+
 private:
     // Constants for piece types
     static const int EMPTY = 0;
@@ -42,23 +55,31 @@ private:
 
     // Helper methods
     Bit*        createPiece(int pieceType);
-    int         getPieceType(const Bit& bit) const;
-    bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
+    // recreates the grid's pieces from the bitboards
+    void        syncBoardToGrid();
+    // square index of a grid square, -1 for a light square
+    int         squareIndex(BitHolder &holder) const;
+    // plays a finished move on the board once the grid shows it, then ends the turn
+    void        finishMove(const CheckersMove &move, Bit &bit);
+    // refills _moves and _targets for the side to move
+    void        generateMoves();
+    // sets up the pieces of a 32 character state string
+    void        loadState(const std::string &s, int sideToMove, int quietPlies);
 
-    // Board representation
+    // Board representation, the grid only mirrors _board for drawing
     Grid*        _grid;
+    CheckersBoard _board;
+    std::vector<CheckersMove> _moves;
+    // per source square, the squares its piece can be dropped on
+    uint32_t    _targets[32] = {};
+    TranspositionTable _tt;
+    CheckersSearch _search;
+    // index of the search's last completed iteration's move, written by the worker
+    std::atomic<int> _bestSoFar;
 
-    // Game state
-    bool        _mustContinueJumping;
-    BitHolder*  _jumpingPiece;
-    int         _redPieces;
-    int         _yellowPieces;
+    // a capture chain being dragged hop by hop: where it started, where the piece is
+    // now and what it has jumped. _chainFrom is -1 outside a chain
+    int         _chainFrom;
+    int         _chainSquare;
+    uint32_t    _chainCaptured;
 };
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "CheckersBoard.h"
+
+using namespace CheckersBits;
+
+void CheckersBoard::reset()
+{
+    set(0x00000FFFu, 0xFFF00000u, 0, RED_PLAYER);
+}
+
+void CheckersBoard::set(uint32_t red, uint32_t yellow, uint32_t kings, int sideToMove, int quietPlies)
+{
+    _pieces[RED_PLAYER] = red;
+    _pieces[YELLOW_PLAYER] = yellow & ~red;
+    _kings = kings & (red | yellow);
+    _sideToMove = sideToMove;
+    _quietPlies = quietPlies;
+    _hash = 0;
+    for (uint32_t bits = red | yellow; bits;) {
+        int square = popLSB(bits);
+        _hash ^= Zobrist::boardKey(pieceIndex(square), square);
+    }
+}
+
+int CheckersBoard::pieceIndex(int square) const
+{
+    int player = ((_pieces[YELLOW_PLAYER] >> square) & 1) ? YELLOW_PLAYER : RED_PLAYER;
+    return player * 2 + isKing(square);
+}
+
+bool CheckersBoard::hasCapture() const
+{
+    int us = _sideToMove;
+    uint32_t empty = this->empty();
+    for (int direction = 0; direction < 4; direction++) {
+        uint32_t movers = _pieces[us];
+        if (!((directionsFor(us, false) >> direction) & 1)) {
+            movers &= _kings;
+        }
+        if (step(step(movers, direction) & _pieces[us ^ 1], direction) & empty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int CheckersBoard::generateMoves(CheckersMove *moves) const
+{
+    int us = _sideToMove;
+    CheckersMove *out = moves;
+
+    if (hasCapture()) {
+        uint32_t empty = this->empty();
+        for (uint32_t pieces = _pieces[us]; pieces;) {
+            int from = popLSB(pieces);
+            // the jumping piece leaves its square, a king can come back round to it
+            addJumps(from, from, 0, isKing(from), empty | (1u << from), out);
+        }
+        return (int)(out - moves);
+    }
+
+    uint32_t empty = this->empty();
+    for (uint32_t pieces = _pieces[us]; pieces;) {
+        int from = popLSB(pieces);
+        uint32_t directions = directionsFor(us, isKing(from));
+        for (int direction = 0; direction < 4; direction++) {
+            if (!((directions >> direction) & 1)) {
+                continue;
+            }
+            uint32_t target = step(1u << from, direction) & empty;
+            if (target) {
+                out->from = (uint8_t)from;
+                out->to = (uint8_t)bitScanForward(target);
+                out->captured = 0;
+                out++;
+            }
+        }
+    }
+    return (int)(out - moves);
+}
+
+// depth first over the chain; jumped pieces stay on the board until the move is over
+void CheckersBoard::addJumps(int from, int square, uint32_t captured, bool king, uint32_t empty, CheckersMove *&out) const
+{
+    int us = _sideToMove;
+    uint32_t directions = directionsFor(us, king);
+    uint32_t bit = 1u << square;
+    bool extended = false;
+
+    for (int direction = 0; direction < 4; direction++) {
+        if (!((directions >> direction) & 1)) {
+            continue;
+        }
+        uint32_t jumped = step(bit, direction) & _pieces[us ^ 1] & ~captured;
+        uint32_t landing = step(jumped, direction) & empty;
+        if (!landing) {
+            continue;
+        }
+        extended = true;
+        int to = bitScanForward(landing);
+        if (!king && (landing & crownRow(us))) {
+            out->from = (uint8_t)from;
+            out->to = (uint8_t)to;
+            out->captured = captured | jumped;
+            out++;
+        } else {
+            addJumps(from, to, captured | jumped, king, empty, out);
+        }
+    }
+
+    if (!extended && captured) {
+        out->from = (uint8_t)from;
+        out->to = (uint8_t)square;
+        out->captured = captured;
+        out++;
+    }
+}
+
+uint32_t CheckersBoard::hopTargets(int from, int square, uint32_t captured) const
+{
+    int us = _sideToMove;
+    bool king = isKing(from);
+    uint32_t empty = this->empty() | (1u << from);
+    uint32_t targets = 0;
+    for (int direction = 0; direction < 4; direction++) {
+        if ((directionsFor(us, king) >> direction) & 1) {
+            uint32_t jumped = step(1u << square, direction) & _pieces[us ^ 1] & ~captured;
+            targets |= step(jumped, direction) & empty;
+        }
+    }
+    return targets;
+}
+
+int CheckersBoard::jumpedSquare(int from, int to)
+{
+    for (int direction = 0; direction < 4; direction++) {
+        uint32_t over = step(1u << from, direction);
+        if (over && step(over, direction) == (1u << to)) {
+            return bitScanForward(over);
+        }
+    }
+    return -1;
+}
+
+void CheckersBoard::play(const CheckersMove &move)
+{
+    int us = _sideToMove;
+    uint32_t fromBit = 1u << move.from;
+    uint32_t toBit = 1u << move.to;
+    bool king = _kings & fromBit;
+
+    _hash ^= Zobrist::boardKey(pieceIndex(move.from), move.from);
+    for (uint32_t bits = move.captured; bits;) {
+        int square = popLSB(bits);
+        _hash ^= Zobrist::boardKey(pieceIndex(square), square);
+    }
+    _pieces[us ^ 1] &= ~move.captured;
+    _kings &= ~move.captured;
+
+    _pieces[us] = (_pieces[us] & ~fromBit) | toBit;
+    _kings &= ~fromBit;
+    if (king || (toBit & crownRow(us))) {
+        _kings |= toBit;
+    }
+    _hash ^= Zobrist::boardKey(pieceIndex(move.to), move.to);
+
+    _quietPlies = (king && !move.captured) ? _quietPlies + 1 : 0;
+    _sideToMove ^= 1;
+}
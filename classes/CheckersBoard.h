@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Zobrist.h"
+
+//
+// checkers position as 32-bit bitboards over the dark squares
+// square s is row s / 4, the (s % 4)th dark square of that row, which is the
+// order the grid's enabled squares are walked in. a diagonal step is a shift
+// by 3, 4 or 5 depending on the row's parity and a jump is always a shift by
+// 7 or 9, so whole sides move with a handful of masks and shifts. red starts
+// on rows 0-2 and moves down the rows, yellow starts on rows 5-7 and moves up.
+// american rules: captures are forced, a chain must be jumped to its end and
+// a man that reaches the far row is crowned and stops there
+//
+
+struct CheckersMove {
+    uint8_t     from = 0;
+    uint8_t     to = 0;
+    uint32_t    captured = 0;   // squares of the pieces jumped
+};
+
+class CheckersBoard
+{
+public:
+    static constexpr int RED_PLAYER = 0;
+    static constexpr int YELLOW_PLAYER = 1;
+    // captures, crowning or man moves reset the count; this many without any is a draw
+    static constexpr int drawPlies = 80;
+    // no position has more moves than this, chains included
+    static constexpr int maxMoves = 128;
+
+    // twelve men each, red to move
+    CheckersBoard() { reset(); }
+
+    void reset();
+    void set(uint32_t red, uint32_t yellow, uint32_t kings, int sideToMove, int quietPlies = 0);
+
+    uint32_t pieces(int player) const { return _pieces[player]; }
+    uint32_t kings() const { return _kings; }
+    uint32_t empty() const { return ~(_pieces[0] | _pieces[1]); }
+    int sideToMove() const { return _sideToMove; }
+    bool isKing(int square) const { return (_kings >> square) & 1; }
+    int quietPlies() const { return _quietPlies; }
+    bool isDraw() const { return _quietPlies >= drawPlies; }
+    uint64_t hash() const { return _sideToMove ? _hash ^ Zobrist::keys.sideToMove : _hash; }
+
+    // every legal move of the side to move, only captures when there are any. returns the count
+    int generateMoves(CheckersMove *moves) const;
+    bool hasCapture() const;
+    void play(const CheckersMove &move);
+
+    // while a chain is played one hop at a time: where the piece that started on
+    // from, now on square, can jump next without jumping anything in captured twice
+    uint32_t hopTargets(int from, int square, uint32_t captured) const;
+    // the piece a jump from -> to passes over, -1 if that isn't a jump
+    static int jumpedSquare(int from, int to);
+
+    // grid coordinates of a square and back
+    static int squareX(int square) { return (square % 4) * 2 + ((square / 4) % 2 == 0 ? 1 : 0); }
+    static int squareY(int square) { return square / 4; }
+    static int squareAt(int x, int y) { return ((x + y) % 2 == 1) ? y * 4 + x / 2 : -1; }
+    // the row a player's men are crowned on
+    static uint32_t crownRow(int player) { return player == RED_PLAYER ? 0xF0000000u : 0x0000000Fu; }
+
+    // piece index for hashing and the state string: red man, red king, yellow man, yellow king
+    int pieceIndex(int square) const;
+
+private:
+    void addJumps(int from, int square, uint32_t captured, bool king, uint32_t empty, CheckersMove *&out) const;
+    uint32_t directionsFor(int player, bool king) const { return king ? 0xF : (player == RED_PLAYER ? 0x3 : 0xC); }
+
+    uint32_t    _pieces[2];
+    uint32_t    _kings;
+    int         _sideToMove;
+    int         _quietPlies;
+    uint64_t    _hash;
+};
+
+namespace CheckersBits {
+
+constexpr uint32_t evenRows = 0x0F0F0F0Fu;
+constexpr uint32_t oddRows = 0xF0F0F0F0u;
+constexpr uint32_t firstColumn = 0x11111111u;
+constexpr uint32_t lastColumn = 0x88888888u;
+
+// one diagonal step of every bit in b: 0 down-left, 1 down-right, 2 up-left, 3 up-right,
+// where down is towards row 7. steps off the board fall out of the word
+inline uint32_t step(uint32_t b, int direction)
+{
+    switch (direction) {
+    case 0: return ((b & evenRows) << 4) | ((b & oddRows & ~firstColumn) << 3);
+    case 1: return ((b & evenRows & ~lastColumn) << 5) | ((b & oddRows) << 4);
+    case 2: return ((b & evenRows) >> 4) | ((b & oddRows & ~firstColumn) >> 5);
+    default: return ((b & evenRows & ~lastColumn) >> 3) | ((b & oddRows) >> 4);
+    }
+}
+
+}
@@ -0,0 +1,214 @@
+#include "CheckersSearch.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+using SearchScores::INFINITE_SCORE;
+using SearchScores::WIN_SCORE;
+// a side with no moves has lost, sooner is worse
+constexpr int WIN_IN_MAX_PLY = WIN_SCORE - 256;
+constexpr int maxPly = 128;
+
+constexpr int manValue = 100;
+constexpr int kingValue = 160;
+constexpr int advanceBonus = 3;     // per row a man has come forward
+constexpr int backRowBonus = 12;    // per man still guarding the crowning row
+constexpr int centerBonus = 6;
+constexpr int tempoBonus = 5;
+
+// the eight middle squares of rows 3 and 4 and the middle of rows 2 and 5
+constexpr uint32_t centerSquares = 0x00666600u;
+
+constexpr int orderTTMove = 1 << 30;
+constexpr int orderCapture = 1 << 24;
+constexpr int orderCrown = 1 << 22;
+constexpr int historyMax = 1 << 20;
+
+}
+
+CheckersSearch::CheckersSearch(TranspositionTable &tt) : _tt(tt), _stop(false), _nodes(0)
+{
+    memset(_history, 0, sizeof(_history));
+}
+
+int CheckersSearch::evaluate(const CheckersBoard &board)
+{
+    int score[2] = { 0, 0 };
+    for (int player = 0; player < 2; player++) {
+        uint32_t pieces = board.pieces(player);
+        uint32_t men = pieces & ~board.kings();
+        score[player] += manValue * popCount(men) + kingValue * popCount(pieces & board.kings());
+        score[player] += centerBonus * popCount(pieces & centerSquares);
+        // the row a man starts from is the other side's crowning row
+        score[player] += backRowBonus * popCount(men & CheckersBoard::crownRow(player ^ 1));
+        while (men) {
+            int row = CheckersBoard::squareY(popLSB(men));
+            score[player] += advanceBonus * (player == CheckersBoard::RED_PLAYER ? row : 7 - row);
+        }
+    }
+    int us = board.sideToMove();
+    return score[us] - score[us ^ 1] + tempoBonus;
+}
+
+CheckersSearchResult CheckersSearch::search(const CheckersBoard &root, const CheckersSearchLimits &limits)
+{
+    _deadline.start(limits.moveTimeMs);
+    _stop.store(false, std::memory_order_relaxed);
+    _nodes = 0;
+    _tt.newSearch();
+    for (auto &side : _history) {
+        for (auto &from : side) {
+            for (int &score : from) {
+                score /= 8;
+            }
+        }
+    }
+
+    CheckersSearchResult result;
+    CheckersMove moves[CheckersBoard::maxMoves];
+    int count = root.generateMoves(moves);
+    if (!count) {
+        result.score = -WIN_SCORE;
+        return result;
+    }
+    result.move = moves[0];
+    result.found = true;
+    // a forced move needs no thought
+    if (count == 1) {
+        return result;
+    }
+
+    iterativeDeepening(std::clamp(limits.maxDepth, 1, maxPly - 1), WIN_IN_MAX_PLY, _deadline,
+        [&](int depth) { return alphaBeta(root, -INFINITE_SCORE, INFINITE_SCORE, depth, 0); },
+        [&]() { return stopped(); },
+        [&](int score, int depth) {
+            result.move = _rootMove;
+            result.score = score;
+            result.depth = depth;
+            result.nodes = _nodes;
+            result.elapsedMs = _deadline.elapsedMs();
+            if (_onIteration) {
+                _onIteration(result);
+            }
+        });
+
+    result.nodes = _nodes;
+    result.elapsedMs = _deadline.elapsedMs();
+    return result;
+}
+
+int CheckersSearch::alphaBeta(const CheckersBoard &board, int alpha, int beta, int depth, int ply)
+{
+    if ((++_nodes & 4095) == 0 && _deadline.expired()) {
+        stop();
+    }
+    if (stopped()) {
+        return 0;
+    }
+    if (ply > 0 && board.isDraw()) {
+        return 0;
+    }
+
+    CheckersMove moves[CheckersBoard::maxMoves];
+    int count = board.generateMoves(moves);
+    if (!count) {
+        return -WIN_SCORE + ply;
+    }
+    // the horizon waits for pending captures to be played out
+    bool captures = moves[0].captured != 0;
+    if ((depth <= 0 && !captures) || ply >= maxPly - 1) {
+        return evaluate(board);
+    }
+    depth = std::max(depth, 1);
+
+    uint64_t key = board.hash();
+    TranspositionTable::Entry entry;
+    uint16_t ttMove = 0;
+    if (_tt.probe(key, entry)) {
+        ttMove = entry.move;
+        int ttScore = scoreFromTT(entry.score, ply, WIN_IN_MAX_PLY);
+        if (ply > 0 && entry.depth >= depth
+            && (entry.bound == TranspositionTable::BOUND_EXACT
+                || (entry.bound == TranspositionTable::BOUND_LOWER && ttScore >= beta)
+                || (entry.bound == TranspositionTable::BOUND_UPPER && ttScore <= alpha))) {
+            return ttScore;
+        }
+    }
+
+    orderMoves(moves, count, ttMove, board.sideToMove());
+
+    int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    CheckersMove bestMove = moves[0];
+    for (int i = 0; i < count; i++) {
+        CheckersBoard child = board;
+        child.play(moves[i]);
+
+        int score;
+        if (i == 0) {
+            score = -alphaBeta(child, -beta, -alpha, depth - 1, ply + 1);
+        } else {
+            score = -alphaBeta(child, -alpha - 1, -alpha, depth - 1, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(child, -beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > best) {
+            best = score;
+            bestMove = moves[i];
+            if (ply == 0) {
+                _rootMove = bestMove;
+            }
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    if (!bestMove.captured) {
+                        int &history = _history[board.sideToMove()][bestMove.from][bestMove.to];
+                        history = std::min(history + depth * depth, historyMax);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    TranspositionTable::Bound bound = best >= beta ? TranspositionTable::BOUND_LOWER
+        : best > originalAlpha ? TranspositionTable::BOUND_EXACT : TranspositionTable::BOUND_UPPER;
+    _tt.store(key, scoreToTT(best, ply, WIN_IN_MAX_PLY), depth, bound, packMove(bestMove));
+    return best;
+}
+
+// table move, then the longest captures, then crownings, then history
+void CheckersSearch::orderMoves(CheckersMove *moves, int count, uint16_t ttMove, int us) const
+{
+    int scores[CheckersBoard::maxMoves];
+    for (int i = 0; i < count; i++) {
+        const CheckersMove &move = moves[i];
+        int score = _history[us][move.from][move.to];
+        if (packMove(move) == ttMove) {
+            score += orderTTMove;
+        }
+        score += popCount(move.captured) * orderCapture;
+        if ((1u << move.to) & CheckersBoard::crownRow(us)) {
+            score += orderCrown;
+        }
+        scores[i] = score;
+    }
+    // insertion sort, the lists are short
+    for (int i = 1; i < count; i++) {
+        CheckersMove move = moves[i];
+        int score = scores[i];
+        int j = i;
+        for (; j > 0 && scores[j - 1] < score; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
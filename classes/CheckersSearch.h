@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CheckersBoard.h"
+#include "SearchCommon.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <functional>
+
+//
+// checkers search
+// principal variation alpha-beta inside iterative deepening over the bitboard
+// board, with a transposition table for move ordering and cutoffs. the
+// horizon never stops in the middle of a capture sequence: while captures are
+// pending the search carries on with them. like the othello search it runs on
+// one thread and starts its own table generation
+//
+
+struct CheckersSearchLimits {
+    int         maxDepth = 64;
+    int         moveTimeMs = 0;     // hard budget for this move, 0 for none
+};
+
+struct CheckersSearchResult {
+    CheckersMove move;
+    bool        found = false;      // false when the side to move has lost
+    int         score = 0;
+    int         depth = 0;          // last completed iteration
+    uint64_t    nodes = 0;
+    int         elapsedMs = 0;
+};
+
+class CheckersSearch
+{
+public:
+    explicit CheckersSearch(TranspositionTable &tt);
+
+    // called after every completed iteration
+    void setIterationCallback(std::function<void(const CheckersSearchResult &)> callback) { _onIteration = std::move(callback); }
+
+    CheckersSearchResult search(const CheckersBoard &root, const CheckersSearchLimits &limits);
+    void stop() { _stop.store(true, std::memory_order_relaxed); }
+
+    // static evaluation from the side to move's point of view
+    static int evaluate(const CheckersBoard &board);
+
+    // 16-bit form of a move for the table; a chain is named by its ends
+    static uint16_t packMove(const CheckersMove &move) { return (uint16_t)(1 << 10 | move.from | move.to << 5); }
+
+private:
+    int alphaBeta(const CheckersBoard &board, int alpha, int beta, int depth, int ply);
+    void orderMoves(CheckersMove *moves, int count, uint16_t ttMove, int us) const;
+    bool stopped() const { return _stop.load(std::memory_order_relaxed); }
+
+    TranspositionTable &    _tt;
+    std::function<void(const CheckersSearchResult &)> _onIteration;
+    SearchDeadline          _deadline;
+    std::atomic<bool>       _stop;
+    uint64_t                _nodes;
+    CheckersMove            _rootMove;
+    // quiet moves that caused cutoffs, by side, from and to
+    int                     _history[2][32][32];
+};
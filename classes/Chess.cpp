@@ -1,54 +1,24 @@
 #include "Chess.h"
+#include <algorithm>
+#include <iterator>
 #include <limits>
 #include <cmath>
+#include <cstring>
 
-Chess::Chess()
+Chess::Chess() : _tt(64), _search(_tt, 0), _bestSoFar(-1)
 {
+    _search.setIterationCallback([this](const SearchResult &result) {
+        _bestSoFar.store(result.bestMove.raw(), std::memory_order_relaxed);
+    });
     _grid = new Grid(8, 8);
-
-    // bitboards
-    for(int i = 0; i < 64; i++){
-        _knightBitboards[i] = generateKnightMoveBitboard(i);
-    }
-
-    // initMagicBitboards();
-
-    for(int i = 0; i < 128; i++){
-        _bitboardLookup[i] = 0;
-    }
-
-    _bitboardLookup['P'] = W_PAWNS;
-    _bitboardLookup['N'] = W_KNIGHTS;
-    _bitboardLookup['B'] = W_BISHOPS;
-    _bitboardLookup['R'] = W_ROOKS;
-    _bitboardLookup['Q'] = W_QUEENS;
-    _bitboardLookup['K'] = W_KING;
-    _bitboardLookup['p'] = B_PAWNS;
-    _bitboardLookup['n'] = B_KNIGHTS;
-    _bitboardLookup['b'] = B_BISHOPS;
-    _bitboardLookup['r'] = B_ROOKS;
-    _bitboardLookup['q'] = B_QUEENS;
-    _bitboardLookup['k'] = B_KING;
-    _bitboardLookup['0'] = EMPTY_SQUARES;
 }
 
 Chess::~Chess()
 {
+    cancelAI();
     delete _grid;
 }
 
-char Chess::pieceNotation(int x, int y) const
-{
-    const char *wpieces = { "0PNBRQK" };
-    const char *bpieces = { "0pnbrqk" };
-    Bit *bit = _grid->getSquare(x, y)->bit();
-    char notation = '0';
-    if (bit) {
-        notation = bit->gameTag() < 128 ? wpieces[bit->gameTag()] : bpieces[bit->gameTag()-128];
-    }
-    return notation;
-}
-
 Bit* Chess::PieceForPlayer(const int playerNumber, ChessPiece piece)
 {
     const char* pieces[] = { "pawn.png", "knight.png", "bishop.png", "rook.png", "queen.png", "king.png" };
@@ -73,76 +43,41 @@ void Chess::setUpBoard()
     _grid->initializeChessSquares(pieceSize, "boardsquare.png");
     FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
 
-    _currentPlayer = WHITE;
-    _moves = generateAllMoves();
+    generateAllMoves();
+    _tt.clear();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
     startGame();
 }
 
 void Chess::FENtoBoard(const std::string& fen) {
-    int field = 0;
-    int x = 0;
-    int y = _gameOptions.rowY - 1;
-    for(char c : fen){
-        if(c == ' '){
-            field++;
-
-            // field 0 = piece placement (handled below)
-            // TODO: handling other fields...
-            // field 1 = active color
-            // field 2 = castling rights
-            // field 3 = en passant targets
-            // field 4 = halfmove clock
-            // field 5 = fullmove number
-
-            continue;
-        }
-
-        if(field > 0){ continue; }
+    if (_position.setFEN(fen)) {
+        syncBoardFromPosition();
+    }
+}
 
-        //* PIECE PLACEMENT *//
-        if(c >= '0' && c <= '9'){   // numerics indicate empty spaces
-            int num_empty = c - '0';
-            x += num_empty - 1;
-            continue;
-        }
-        
-        if(c == '/'){   // move to next row
-            y--;
-            x = 0;
-            continue;
+// rebuilds the grid's pieces from the engine position
+void Chess::syncBoardFromPosition()
+{
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+        int piece = _position.pieceAt(y * 8 + x);
+        if (piece == NO_PIECE) {
+            return;
         }
-
-        ChessSquare* square = _grid->getSquare(x, y);   // get current square
+        int player = Position::pieceColor(piece);
+        ChessPiece type = Position::pieceType(piece);
         _grid->setEnabled(x, y, true);
 
-        // convert char to piece
-        ChessPiece guy;
-
-        // get color 
-        char c_tolower = tolower(c);    // if this is not the same as c, then c is caps (white)
-        int player = (c == c_tolower) ? BLACK : WHITE;
-
-        if      (c_tolower == 'p'){ guy = Pawn; }
-        else if (c_tolower == 'r'){ guy = Rook; }
-        else if (c_tolower == 'n'){ guy = Knight; }
-        else if (c_tolower == 'b'){ guy = Bishop; }
-        else if (c_tolower == 'q'){ guy = Queen; }
-        else if (c_tolower == 'k'){ guy = King; }
-        else { 
-            // TODO: LOG ERROR
-            guy = NoPiece; 
-        }
-
-        // place piece
-        Bit* piece = PieceForPlayer(player, guy);   // make piece
-        piece->setParent(square);
-        int notation = (player == BLACK) ? (guy + 128) : guy; // this feels hacky // TODO: fix?
-        piece->setGameTag(notation);              // set tag to piece notation
-        piece->setPosition(square->getPosition());  // put it on the board
-        square->setBit(piece);
-        x++;
-    }
-    
+        Bit* bit = PieceForPlayer(player, type);
+        bit->setParent(square);
+        bit->setGameTag(player == BLACK ? type + 128 : type);
+        bit->setPosition(square->getPosition());
+        square->setBit(bit);
+    });
 }
 
 bool Chess::actionForEmptyHolder(BitHolder &holder)
@@ -158,13 +93,7 @@ bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
     if (pieceColor != currentPlayer) return false;
 
     ChessSquare *square = (ChessSquare *)&src;
-    int squareIndex = square->getSquareIndex();
-    for(auto move : _moves){
-        if(move.from == squareIndex){
-            return true;
-        }
-    }
-    return false;
+    return _targets[square->getSquareIndex()] != 0;
 }
 
 bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
@@ -172,18 +101,12 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
     ChessSquare *srcSquare = (ChessSquare *)&src;
     ChessSquare *dstSquare = (ChessSquare *)&dst;
 
-    int srcSquareIndex = srcSquare->getSquareIndex();
-    int dstSquareIndex = dstSquare->getSquareIndex();
-    for(auto move : _moves){
-        if(move.from == srcSquareIndex && move.to == dstSquareIndex){
-            return true;
-        }
-    }
-    return false;
+    return (_targets[srcSquare->getSquareIndex()] >> dstSquare->getSquareIndex()) & 1;
 }
 
 void Chess::stopGame()
 {
+    cancelAI();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
@@ -204,12 +127,16 @@ Player* Chess::ownerAt(int x, int y) const
 
 Player* Chess::checkForWinner()
 {
+    // checkmated: the side to move has no moves and is in check
+    if (_moves.empty() && _position.inCheck()) {
+        return getPlayerAt(_position.sideToMove() ^ 1);
+    }
     return nullptr;
 }
 
 bool Chess::checkForDraw()
 {
-    return false;
+    return (_moves.empty() && !_position.inCheck()) || _position.halfmoveClock() >= 100;
 }
 
 std::string Chess::initialStateString()
@@ -219,241 +146,216 @@ std::string Chess::initialStateString()
 
 std::string Chess::stateString()
 {
-    std::string s;
-    s.reserve(64);
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-            s += pieceNotation( x, y );
-        }
-    );
+    std::string s(64, '0');
+    for (int square = 0; square < 64; square++) {
+        s[square] = _position.pieceNotation(square);
+    }
     return s;
 }
 
+// takes a full FEN, or the 64 character board from stateString() with the
+// side to move kept and castling rights read off the home squares
 void Chess::setStateString(const std::string &s)
 {
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 8 + x;
-        char playerNumber = s[index] - '0';
-        if (playerNumber) {
-            square->setBit(PieceForPlayer(playerNumber - 1, Pawn));
-        } else {
-            square->setBit(nullptr);
+    std::string fen = s;
+    if (s.size() == 64 && s.find('/') == std::string::npos) {
+        fen.clear();
+        for (int rank = 7; rank >= 0; rank--) {
+            int empty = 0;
+            for (int file = 0; file < 8; file++) {
+                char c = s[rank * 8 + file];
+                if (c == '0') {
+                    empty++;
+                    continue;
+                }
+                if (empty) {
+                    fen += (char)('0' + empty);
+                    empty = 0;
+                }
+                fen += c;
+            }
+            if (empty) {
+                fen += (char)('0' + empty);
+            }
+            if (rank) {
+                fen += '/';
+            }
         }
-    });
-}
+        std::string castling;
+        if (s[4] == 'K' && s[7] == 'R') castling += 'K';
+        if (s[4] == 'K' && s[0] == 'R') castling += 'Q';
+        if (s[60] == 'k' && s[63] == 'r') castling += 'k';
+        if (s[60] == 'k' && s[56] == 'r') castling += 'q';
+        fen += _position.sideToMove() == WHITE ? " w " : " b ";
+        fen += castling.empty() ? "-" : castling;
+        fen += " - 0 1";
+    }
 
-// MOVE GENERATIONS //
-void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst){
-    _currentPlayer = (_currentPlayer == WHITE) ? BLACK : WHITE;
-    _moves = generateAllMoves();
-    clearBoardHighlights();
-    endTurn();
+    if (!_position.setFEN(fen)) {
+        return;
+    }
+    syncBoardFromPosition();
+    generateAllMoves();
 }
 
-std::vector<BitMove> Chess::generateAllMoves(){
-    std::vector<BitMove> moves;
-    moves.reserve(32);
-    std::string state = stateString();
-
-    for(int i = 0; i < e_numBitboards; i++){
-        _bitboards[i] = 0;
+std::string Chess::historyState()
+{
+    PackedPosition packed;
+    if (!_position.pack(packed)) {
+        return _position.fen();
     }
+    return std::string(reinterpret_cast<const char *>(packed.bytes), sizeof(packed.bytes));
+}
 
-    for(int i = 0; i < 64; i++){
-        int bitIndex = _bitboardLookup[state[i]];
-        _bitboards[bitIndex] |= 1ULL << i;
-        if(state[i] != '0'){
-            _bitboards[OCCUPANCY] |= 1ULL << i;
-            _bitboards[isupper(state[i]) ? W_ALL : B_ALL] |= 1ULL << i;
+void Chess::setHistoryState(const std::string &s)
+{
+    PackedPosition packed;
+    if (s.size() == sizeof(packed.bytes)) {
+        memcpy(packed.bytes, s.data(), sizeof(packed.bytes));
+        if (!_position.unpack(packed)) {
+            return;
         }
+    } else if (!_position.setFEN(s)) {
+        return;
     }
+    syncBoardFromPosition();
+    generateAllMoves();
+}
 
-    int bitIndex = _currentPlayer == WHITE ? W_PAWNS : B_PAWNS;
-    int oppBitIndex = _currentPlayer == BLACK ? W_PAWNS : B_PAWNS;
-
-    int enemyBoardIndex = _currentPlayer == WHITE ? B_ALL : W_ALL;
-
-    // pawns
-    generatePawnMoves(moves, _bitboards[W_PAWNS + bitIndex], ~_bitboards[OCCUPANCY].getData(), _bitboards[enemyBoardIndex], _currentPlayer);
-
-    // knights
-    generateKnightMoves(moves, _bitboards[W_KNIGHTS + bitIndex], ~_bitboards[OCCUPANCY].getData());
+// MOVE GENERATIONS //
+void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst){
+    ChessSquare *srcSquare = (ChessSquare *)&src;
+    ChessSquare *dstSquare = (ChessSquare *)&dst;
 
-    // kings
-    uint64_t kingBoard = _bitboards[W_KING + bitIndex].getData();
-    while(kingBoard){
-        int sq = bitScanForward(kingBoard);
-        generateKingMoves(state.c_str(), moves, sq / 8, sq & 7);
-        kingBoard &= (kingBoard - 1);
+    const BitMove *played = findMove(srcSquare->getSquareIndex(), dstSquare->getSquareIndex());
+    if (played) {
+        commitMove(*played, dst);
+        return;
     }
 
-    return moves;
-}
-
-void Chess::generateKnightMoves(std::vector<BitMove>& moves, BitboardElement knights, uint64_t occupancy){
-    knights.forEachBit([&](int from){
-        BitboardElement canMoveTo = _knightBitboards[from].getData() & occupancy;
-        canMoveTo.forEachBit([&](int to){
-            moves.emplace_back(from, to, Knight);
-        });
-    });
+    // canBitMoveFromTo() only allows legal moves, but if the grid and position ever
+    // disagree put the pieces back where the position has them, it's still our turn
+    clearBoardHighlights();
+    syncBoardFromPosition();
 }
 
-void Chess::generateKnightMoves(std::vector<BitMove>& moves, std::string &state){
-    // L-shape offsets
-    std::pair<int, int> offsets[] = {
-        {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
-    };
-
-    char knightPiece = _currentPlayer == WHITE ? 'N' : 'n';
-    int index = 0;
-    for(char sq : state){
-        if(sq == knightPiece){
-            int rank = index / 8;
-            int file = index % 8;
+// the piece is already on dst, play the move on the position and finish the turn
+void Chess::commitMove(const BitMove &move, BitHolder &dst)
+{
+    BitMove played = move;
+    UndoState undo;
+    _position.makeMove(played, undo);
+    mirrorSpecialMove(played, dst);
 
-            constexpr uint64_t oneBit = 1;
-            for(auto [dr, df] : offsets){
-                int r = rank + dr;
-                int f = file + df;
+    generateAllMoves();
+    clearBoardHighlights();
+    endTurn();
+}
 
-                if(r >= 0 && r < 8 && f >=0 && f < 8){
-                    moves.emplace_back(index, r * 8 + f, Knight);
-                }
-            }
-        }
-        index++;
+//
+// search the current position and play the best move found, blocking
+//
+void Chess::updateAI()
+{
+    std::function<int()> job = makeAISearch();
+    if (job) {
+        applyAIMove(job());
     }
 }
 
-BitboardElement Chess::generateKnightMoveBitboard(int square){
-    // L-shape offsets
-    std::pair<int, int> offsets[] = {
-        {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
-    };
-
-    BitboardElement bb = 0ULL;
-    int rank = square / 8;
-    int file = square % 8;
-
-    constexpr uint64_t oneBit = 1;
-    for(auto [dr, df] : offsets){
-        int r = rank + dr;
-        int f = file + df;
-
-        if(r >= 0 && r < 8 && f >=0 && f < 8){
-            bb |= oneBit << (r * 8 + f);
-        }
+// everything the search reads is copied here, the worker never sees the live position
+std::function<int()> Chess::makeAISearch()
+{
+    if (_moves.empty()) {
+        return nullptr;
     }
 
-    return bb;
-}
+    SearchLimits limits;
+    aiSearchBudget(limits.maxDepth, limits.moveTimeMs);
 
+    // every position so far except the current one, so the engine can see repetitions
+    std::vector<uint64_t> history;
+    for (int ply = 0; ply < _history.current(); ply++) {
+        history.push_back(_history.hashAt(ply));
+    }
+    _search.setThreads(_gameOptions.AIThreads);
+    _search.setHistory(history);
+    _bestSoFar.store(-1, std::memory_order_relaxed);
 
-void Chess::generateBishopMoves(const char* state, std::vector<BitMove>& moves, int row, int col){
-    static const std::vector<std::pair<int, int>> diagonals = {
-        {1,1}, {1, -1}, {-1, 1}, {-1, -1}
+    return [this, position = _position, limits]() {
+        SearchResult result = _search.search(position, limits);
+        return (int)result.bestMove.raw();
     };
-
-    generateLinearMoves(state, moves, row, col, diagonals);
 }
 
-void Chess::generateLinearMoves(const char* state, std::vector<BitMove>& moves, int row, int col, const std::vector<std::pair<int, int>> directions){
-    for( auto &dir : directions){
-        int currRow = row + dir.first;
-        int currCol = col + dir.second;
-
-        while(currRow >= 0 && currRow < 8 && currCol >= 0 && currCol < 8){
-            if(pieceNotation(currCol, currRow) != '0'){
-                addMoveIfValid(state, moves, row, col, currRow, currCol);
-                break;
-            }
-
-            addMoveIfValid(state, moves, row, col, currRow, currCol);
-            currRow += dir.first;
-            currCol += dir.second;
+void Chess::applyAIMove(int move)
+{
+    const BitMove *found = nullptr;
+    for (const BitMove &legal : _moves) {
+        if (legal.raw() == move) {
+            found = &legal;
+            break;
         }
     }
+    if (!found) {
+        return;
+    }
 
+    BitMove played = *found;
+    ChessSquare *src = _grid->getSquareByIndex(played.from());
+    ChessSquare *dst = _grid->getSquareByIndex(played.to());
+    Bit *bit = src->bit();
+    if (!bit || !dst->dropBitAtPoint(bit, dst->getPosition())) {
+        return;
+    }
+    src->draggedBitTo(bit, dst);
+    commitMove(played, *dst);
 }
 
-int Chess::stateColor(const char* state, int row, int col){
-    char piece = pieceNotation(col, row);
-    if(piece == '0') return -2;
-    return (piece < 'a') ? WHITE : BLACK;
-}
-
-void Chess::addMoveIfValid(const char* state, std::vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol){
-    if(toRow >= 0 && toRow < 8 && toCol >= 0 && toCol < 8){
-        int fromColor = stateColor(state, fromRow, fromCol);
-        int toColor = stateColor(state, toRow, toCol);
-        if(fromColor != toColor){
-            moves.emplace_back(fromRow*8+fromCol, toRow*8+toCol, Knight);
+// promotions are generated queen first, so a dragged pawn always queens
+const BitMove* Chess::findMove(int from, int to) const
+{
+    for (const BitMove &move : _moves) {
+        if (move.from() == from && move.to() == to) {
+            return &move;
         }
     }
+    return nullptr;
 }
 
-
-// TODO: replace ternaries with template (isWhite)
-void Chess::generatePawnMoves(std::vector<BitMove>& moves, BitboardElement pawns, const BitboardElement empty, const BitboardElement enemies, char color){
-    if(pawns.getData() == 0){
-        return;
+// the dragged piece is already on dst, fix up anything else the move changed
+void Chess::mirrorSpecialMove(const BitMove &move, BitHolder &dst)
+{
+    int color = Position::pieceColor(_position.pieceAt(move.to()));
+
+    if (move.flags() == MoveEnPassant) {
+        int capturedSquare = (color == WHITE) ? move.to() - 8 : move.to() + 8;
+        _grid->getSquareByIndex(capturedSquare)->destroyBit();
+    } else if (move.flags() == MoveCastle) {
+        bool kingSide = move.to() > move.from();
+        ChessSquare *rookSrc = _grid->getSquareByIndex(kingSide ? move.to() + 1 : move.to() - 2);
+        ChessSquare *rookDst = _grid->getSquareByIndex(kingSide ? move.to() - 1 : move.to() + 1);
+        Bit *rook = rookSrc->bit();
+        if (rook) {
+            rookDst->setBit(rook);
+            rookSrc->setBit(nullptr);
+            rook->moveTo(rookDst->getPosition());
+        }
+    } else if (move.isPromotion()) {
+        ChessPiece promoted = move.promotionPiece();
+        Bit *piece = PieceForPlayer(color, promoted);
+        piece->setGameTag(color == BLACK ? promoted + 128 : promoted);
+        piece->setPosition(dst.getPosition());
+        dst.setBit(piece);
     }
-
-    // constants for ranks and files
-    constexpr uint64_t notAFile (0xFEFEFEFEFEFEFEFEULL);
-    constexpr uint64_t notHFile (0x7F7F7F7F7F7F7F7FULL);
-    constexpr uint64_t rank3    (0x0000000000FF0000ULL);
-    constexpr uint64_t rank6    (0x0000FF0000000000ULL);
-
-    BitboardElement demoRight(notAFile);
-    BitboardElement demoLeft(notHFile);
-
-    BitboardElement singleMoves = (color == WHITE) ? 
-        (pawns.getData() << 8) & empty.getData() :
-        (pawns.getData() >> 8) & empty.getData() ;
-    BitboardElement doubleMoves = (color == WHITE) ? 
-        ((singleMoves.getData() & rank3) << 8) & empty.getData() :
-        ((singleMoves.getData() & rank6) >> 8) & empty.getData() ;
-
-    BitboardElement capturesLeft = (color == WHITE) ? 
-        ((pawns.getData() & notHFile) << 7) & enemies.getData() :
-        ((pawns.getData() & notAFile) >> 9) & enemies.getData() ;
-    BitboardElement capturesRight = (color == WHITE) ? 
-        ((pawns.getData() & notAFile) << 9) & enemies.getData() :
-        ((pawns.getData() & notHFile) >> 7) & enemies.getData() ;
-
-    int forwardSingleShift  = (color == WHITE) ? 8 : -8;
-    int forwardDoubleShift  = (color == WHITE) ? 16 : -16;
-    int captureLeftShift    = (color == WHITE) ? 7 : -9;
-    int captureRightShift   = (color == WHITE) ? 9 : -7;
-
-    addPawnBitboardMovesToList(moves, singleMoves, forwardSingleShift);
-    addPawnBitboardMovesToList(moves, doubleMoves, forwardDoubleShift);
-    addPawnBitboardMovesToList(moves, capturesLeft, captureLeftShift);
-    addPawnBitboardMovesToList(moves, capturesRight, captureRightShift);
 }
 
-void Chess::addPawnBitboardMovesToList(std::vector<BitMove>& moves, const BitboardElement bitboard, const int shift){
-    if(bitboard.getData() == 0) return;
-    bitboard.forEachBit([&](int to){
-        int from = to - shift;
-        moves.emplace_back(from, to, Pawn);
-    });
-}
-
-void Chess::generateKingMoves(const char *state, std::vector<BitMove> &moves, int row, int col){
-    std::vector<std::pair<int, int>> directions = {
-        {1,0}, {-1,0}, {0,1}, {0, -1}, {1,1}, {1,-1}, {-1,1}, {-1,-1}
-    };
+void Chess::generateAllMoves(){
+    _moves.clear();
+    _position.generateLegalMoves(_moves);
 
-    for(auto &dir : directions){
-        int newRow = row + dir.first;
-        int newCol = col + dir.second;
-
-        if(newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8){
-            addMoveIfValid(state, moves, row, col, newRow, newCol);
-        }
+    std::fill(std::begin(_targets), std::end(_targets), 0);
+    for (const BitMove &move : _moves) {
+        _targets[move.from()] |= 1ULL << move.to();
     }
-}
\ No newline at end of file
+}
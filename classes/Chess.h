@@ -2,31 +2,10 @@
 
 #include "Game.h"
 #include "Grid.h"
-#include "Bitboard.h"
+#include "Position.h"
+#include "ParallelSearch.h"
 
 constexpr int pieceSize = 80;
-constexpr int WHITE = 0;
-constexpr int BLACK = 1;
-
-enum AllBitBoards {
-    W_PAWNS,
-    W_KNIGHTS,
-    W_BISHOPS,
-    W_ROOKS,
-    W_QUEENS,
-    W_KING,
-    B_PAWNS,
-    B_KNIGHTS,
-    B_BISHOPS,
-    B_ROOKS,
-    B_QUEENS,
-    B_KING,
-    W_ALL,
-    B_ALL,
-    OCCUPANCY,
-    EMPTY_SQUARES,
-    e_numBitboards
-};
 
 class Chess : public Game
 {
@@ -48,56 +27,43 @@ public:
     std::string initialStateString() override;
     std::string stateString() override;
     void setStateString(const std::string &s) override;
+    // the packed position, so side to move, castling, en passant and the clocks come back too
+    std::string historyState() override;
+    void setHistoryState(const std::string &s) override;
+    uint64_t zobristKey() override { return _position.hash(); }
+
+    void updateAI() override;
+    bool gameHasAI() override { return true; }
+    int bestAIMoveSoFar() override { return _bestSoFar.load(std::memory_order_relaxed); }
 
     Grid* getGrid() override { return _grid; }
 
+protected:
+    std::function<int()> makeAISearch() override;
+    void applyAIMove(int move) override;
+    void stopAISearch() override { _search.stop(); }
+
 private:
     Bit* PieceForPlayer(const int playerNumber, ChessPiece piece);
     Player* ownerAt(int x, int y) const;
     void FENtoBoard(const std::string& fen);
-    char pieceNotation(int x, int y) const;
-
-    // player colors
-    int stateColor(const char* state, int row, int col);
-    int _currentPlayer;
-    Grid* _grid;
+    void syncBoardFromPosition();
 
     // generating moves
-    std::vector<BitMove> generateAllMoves();
+    void generateAllMoves();
     void bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst);
-    void addMoveIfValid(const char* state, std::vector<BitMove>& moves, int fromRow, int fromCol, int toRow, int toCol);
-
+    const BitMove* findMove(int from, int to) const;
+    void mirrorSpecialMove(const BitMove &move, BitHolder &dst);
+    void commitMove(const BitMove &move, BitHolder &dst);
 
-    // knights
-    BitboardElement generateKnightMoveBitboard(int square);
-    void generateKnightMoves(std::vector<BitMove>& moves, std::string &state);
-    void generateKnightMoves(std::vector<BitMove>& moves, BitboardElement knights, uint64_t occupancy);
-
-    // bishops
-    // TODO: improve
-    // use templates?
-    void generateBishopMoves(const char* state, std::vector<BitMove>& moves, int row, int col);
-    void generateLinearMoves(const char* state, std::vector<BitMove>& moves, int row, int col, const std::vector<std::pair<int, int>> directions);
-
-    // pawns
-    void generatePawnMoves(std::vector<BitMove>& moves, BitboardElement pawns, const BitboardElement empty, const BitboardElement enemies, char col);
-    void addPawnBitboardMovesToList(std::vector<BitMove>& moves, const BitboardElement bitboard, const int shift);
-
-    // kings
-    void generateKingMoves(const char *state, std::vector<BitMove> &moves, int row, int col);
-
-    std::vector<BitMove> _moves;
-    BitboardElement _knightBitboards[64];
-    BitboardElement _bitboards[e_numBitboards];
-    int _bitboardLookup[128];
-
-    inline int bitScanForward(uint64_t bb) const {
-        #if defined(_MSC_VER) && !defined(__clang__)
-                unsigned long index;
-                _BitScanForward64(&index, bb);
-                return index;
-        #else
-                return __builtin_ffsll(bb) - 1;
-        #endif
-    };
+    Grid* _grid;
+    // the engine's view of the board, the grid mirrors it for drawing
+    Position _position;
+    MoveList _moves;
+    // per source square, the destinations of its legal moves, rebuilt with _moves
+    uint64_t _targets[64] = {};
+    TranspositionTable _tt;
+    ParallelSearch _search;
+    // packed move from the search's last completed iteration, written by the worker
+    std::atomic<int> _bestSoFar;
 };
\ No newline at end of file
@@ -0,0 +1,511 @@
+#include "ChessSearch.h"
+#include "MovePicker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+const int pieceValues[7] = { 0, 100, 320, 330, 500, 900, 0 };
+
+// piece-square tables from white's point of view, rank 8 first so they read like a board.
+// a white piece on square s uses [s ^ 56], a black one uses [s]
+const int pawnTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+const int knightTable[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50
+};
+const int bishopTable[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20
+};
+const int rookTable[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+const int queenTable[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20
+};
+const int kingMiddleTable[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20
+};
+const int kingEndTable[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50
+};
+const int *pieceTables[7] = { nullptr, pawnTable, knightTable, bishopTable, rookTable, queenTable, nullptr };
+
+// game phase weights, 24 with every minor and major piece on the board
+const int phaseWeights[7] = { 0, 0, 1, 1, 2, 4, 0 };
+constexpr int maxPhase = 24;
+
+constexpr int bishopPairBonus = 30;
+constexpr int tempoBonus = 10;
+
+// lazy smp: helper thread n skips iterations in a pattern of skipSize[n] on, skipSize[n] off,
+// shifted by skipPhase[n], so the helpers fill the table at a spread of depths
+const int skipSize[20]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+const int skipPhase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+constexpr int historyMax    = 1 << 20;
+
+bool hasNonPawnMaterial(const Position &position, int color)
+{
+    return position.colorPieces(color) & ~(position.pieces(color, Pawn) | position.pieces(color, King));
+}
+
+}
+
+ChessSearch::ChessSearch(TranspositionTable &tt, std::atomic<bool> *sharedStop)
+    : _tt(tt), _ownStop(false), _stop(sharedStop ? sharedStop : &_ownStop), _threadIndex(0), _nodes(0), _publishedNodes(0), _keysSinceNull(0)
+{
+    for (int depth = 0; depth < 64; depth++) {
+        for (int count = 0; count < 64; count++) {
+            _reductions[depth][count] = (depth && count) ? (int)(0.75 + std::log(depth) * std::log(count) / 2.25) : 0;
+        }
+    }
+    memset(_historyScores, 0, sizeof(_historyScores));
+}
+
+int ChessSearch::evaluate(const Position &position)
+{
+    int score[2] = { 0, 0 };
+    int phase = 0;
+
+    for (int color = WHITE; color <= BLACK; color++) {
+        int flip = (color == WHITE) ? 56 : 0;
+        for (int piece = Pawn; piece <= Queen; piece++) {
+            uint64_t bitboard = position.pieces(color, (ChessPiece)piece);
+            phase += phaseWeights[piece] * popCount(bitboard);
+            while (bitboard) {
+                int square = popLSB(bitboard);
+                score[color] += pieceValues[piece] + pieceTables[piece][square ^ flip];
+            }
+        }
+        if (popCount(position.pieces(color, Bishop)) >= 2) {
+            score[color] += bishopPairBonus;
+        }
+    }
+
+    // the king walks out of its corner as the pieces come off
+    phase = std::min(phase, maxPhase);
+    for (int color = WHITE; color <= BLACK; color++) {
+        int square = position.kingSquare(color) ^ ((color == WHITE) ? 56 : 0);
+        score[color] += (kingMiddleTable[square] * phase + kingEndTable[square] * (maxPhase - phase)) / maxPhase;
+    }
+
+    int us = position.sideToMove();
+    return score[us] - score[us ^ 1] + tempoBonus;
+}
+
+SearchResult ChessSearch::search(const Position &root, const SearchLimits &limits)
+{
+    _limits = limits;
+    _deadline.start(limits.moveTimeMs);
+    // a shared flag is reset by its owner before the threads start
+    if (_stop == &_ownStop) {
+        _ownStop.store(false, std::memory_order_relaxed);
+    }
+    _nodes = 0;
+    _publishedNodes.store(0, std::memory_order_relaxed);
+    _keys = _history;
+    _keysSinceNull = 0;
+    for (auto &killers : _killers) {
+        killers[0] = killers[1] = BitMove();
+    }
+    for (auto &from : _counterMoves) {
+        std::fill(std::begin(from), std::end(from), BitMove());
+    }
+    // keep the move ordering knowledge from the last search but let it fade
+    for (auto &side : _historyScores) {
+        for (auto &from : side) {
+            for (int &score : from) {
+                score /= 8;
+            }
+        }
+    }
+
+    Position position = root;
+    SearchResult result;
+
+    MoveList &rootMoves = _moveLists[0];
+    rootMoves.clear();
+    position.generateLegalMoves(rootMoves);
+    if (rootMoves.empty()) {
+        result.score = position.inCheck() ? -MATE_SCORE : 0;
+        return result;
+    }
+    result.bestMove = rootMoves[0];
+
+    int maxDepth = std::clamp(limits.maxDepth, 1, MAX_PLY - 1);
+    int score = 0;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        if (_threadIndex > 0 && depth > 1) {
+            int i = (_threadIndex - 1) % 20;
+            if (((depth + skipPhase[i]) / skipSize[i]) % 2) {
+                continue;
+            }
+        }
+
+        // aspiration window around the last score, widened on failure
+        int window = 40;
+        int alpha = -INFINITE_SCORE;
+        int beta = INFINITE_SCORE;
+        if (depth >= 5) {
+            alpha = std::max(score - window, -INFINITE_SCORE);
+            beta = std::min(score + window, INFINITE_SCORE);
+        }
+        while (true) {
+            score = pvs(position, alpha, beta, depth, 0, false);
+            if (stopped()) {
+                break;
+            }
+            if (score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - window, -INFINITE_SCORE);
+            } else if (score >= beta) {
+                beta = std::min(score + window, INFINITE_SCORE);
+            } else {
+                break;
+            }
+            window *= 2;
+        }
+        if (stopped()) {
+            break;
+        }
+
+        result.bestMove = _pv[0][0];
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(_pv[0], _pv[0] + _pvLength[0]);
+        result.nodes = _nodes;
+        result.elapsedMs = _deadline.elapsedMs();
+        _publishedNodes.store(_nodes, std::memory_order_relaxed);
+        if (_onIteration) {
+            _onIteration(result);
+        }
+
+        // a found mate won't get any shorter, and another iteration probably won't fit in the budget
+        if (std::abs(score) >= MATE_IN_MAX_PLY && MATE_SCORE - std::abs(score) <= depth) {
+            break;
+        }
+        if (!_deadline.roomForIteration()) {
+            break;
+        }
+    }
+
+    result.nodes = _nodes;
+    result.elapsedMs = _deadline.elapsedMs();
+    _publishedNodes.store(_nodes, std::memory_order_relaxed);
+    return result;
+}
+
+int ChessSearch::pvs(Position &position, int alpha, int beta, int depth, int ply, bool nullAllowed)
+{
+    bool pvNode = beta - alpha > 1;
+    _pvLength[ply] = ply;
+
+    if (depth <= 0) {
+        return quiescence(position, alpha, beta, ply);
+    }
+
+    if ((++_nodes & 2047) == 0) {
+        checkLimits();
+    }
+    if (stopped()) {
+        return 0;
+    }
+
+    if (ply > 0) {
+        if (isDraw(position)) {
+            return 0;
+        }
+        // no line from here can beat a mate we've already found closer to the root
+        alpha = std::max(alpha, -MATE_SCORE + ply);
+        beta = std::min(beta, MATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(position);
+    }
+
+    uint64_t key = position.hash();
+    TranspositionTable::Entry entry;
+    bool ttHit = _tt.probe(key, entry);
+    BitMove ttMove = ttHit ? BitMove(entry.move) : BitMove();
+    if (ttHit && !pvNode && entry.depth >= depth) {
+        int ttScore = scoreFromTT(entry.score, ply, MATE_IN_MAX_PLY);
+        if (entry.bound == TranspositionTable::BOUND_EXACT
+            || (entry.bound == TranspositionTable::BOUND_LOWER && ttScore >= beta)
+            || (entry.bound == TranspositionTable::BOUND_UPPER && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+
+    bool inCheck = position.inCheck();
+    if (inCheck) {
+        depth++;
+    }
+    int staticEval = inCheck ? -INFINITE_SCORE : (ttHit ? entry.eval : evaluate(position));
+
+    if (!pvNode && !inCheck && std::abs(beta) < MATE_IN_MAX_PLY) {
+        // reverse futility: far enough above beta that a shallow search won't come back down
+        if (depth <= 6 && staticEval - 80 * depth >= beta) {
+            return staticEval;
+        }
+        // null move: if passing still beats beta, a real move will too
+        if (nullAllowed && depth >= 3 && staticEval >= beta && hasNonPawnMaterial(position, position.sideToMove())) {
+            int reduction = 3 + depth / 6;
+            UndoState undo;
+            _keys.push_back(key);
+            int keysSinceNull = _keysSinceNull;
+            _keysSinceNull = (int)_keys.size();
+            _playedMoves[ply] = BitMove();
+            position.makeNullMove(undo);
+            int score = -pvs(position, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+            position.unmakeNullMove(undo);
+            _keysSinceNull = keysSinceNull;
+            _keys.pop_back();
+            if (stopped()) {
+                return 0;
+            }
+            if (score >= beta) {
+                return score >= MATE_IN_MAX_PLY ? beta : score;
+            }
+        }
+    }
+
+    int us = position.sideToMove();
+    BitMove previous = ply > 0 ? _playedMoves[ply - 1] : BitMove();
+    BitMove counterMove = previous.isNull() ? BitMove() : _counterMoves[previous.from()][previous.to()];
+    int scores[256];
+    MovePicker picker(position, _moveLists[ply], scores, ttMove, _killers[ply], counterMove, _historyScores[us]);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    BitMove bestMove;
+    int i = 0;
+
+    for (BitMove move = picker.next(); !move.isNull(); move = picker.next(), i++) {
+        bool quiet = !move.isCapture() && !move.isPromotion();
+
+        UndoState undo;
+        _keys.push_back(key);
+        _playedMoves[ply] = move;
+        position.makeMove(move, undo);
+        _tt.prefetch(position.hash());
+
+        int newDepth = depth - 1;
+        int score;
+        if (i == 0) {
+            score = -pvs(position, -beta, -alpha, newDepth, ply + 1, true);
+        } else {
+            // late quiet moves are searched shallower first and only re-searched if they surprise
+            int reduction = 0;
+            if (depth >= 3 && i >= 3 && quiet && !inCheck && !position.inCheck()) {
+                reduction = _reductions[std::min(depth, 63)][std::min(i, 63)];
+                if (pvNode) {
+                    reduction--;
+                }
+                reduction = std::clamp(reduction, 0, newDepth - 1);
+            }
+            score = -pvs(position, -alpha - 1, -alpha, newDepth - reduction, ply + 1, true);
+            if (score > alpha && reduction > 0) {
+                score = -pvs(position, -alpha - 1, -alpha, newDepth, ply + 1, true);
+            }
+            if (score > alpha && score < beta) {
+                score = -pvs(position, -beta, -alpha, newDepth, ply + 1, true);
+            }
+        }
+
+        position.unmakeMove(move, undo);
+        _keys.pop_back();
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                _pv[ply][ply] = move;
+                for (int next = ply + 1; next < _pvLength[ply + 1]; next++) {
+                    _pv[ply][next] = _pv[ply + 1][next];
+                }
+                _pvLength[ply] = std::max(_pvLength[ply + 1], ply + 1);
+            }
+        }
+        if (score >= beta) {
+            if (quiet) {
+                if (!(_killers[ply][0] == move)) {
+                    _killers[ply][1] = _killers[ply][0];
+                    _killers[ply][0] = move;
+                }
+                int &history = _historyScores[us][move.from()][move.to()];
+                history = std::min(history + depth * depth, historyMax);
+                if (!previous.isNull()) {
+                    _counterMoves[previous.from()][previous.to()] = move;
+                }
+            }
+            break;
+        }
+    }
+
+    // nothing was searched, there are no legal moves
+    if (bestScore == -INFINITE_SCORE) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    TranspositionTable::Bound bound = bestScore >= beta ? TranspositionTable::BOUND_LOWER
+        : bestScore > originalAlpha ? TranspositionTable::BOUND_EXACT
+        : TranspositionTable::BOUND_UPPER;
+    _tt.store(key, scoreToTT(bestScore, ply, MATE_IN_MAX_PLY), depth, bound, bestMove.raw(), inCheck ? 0 : staticEval);
+    return bestScore;
+}
+
+int ChessSearch::quiescence(Position &position, int alpha, int beta, int ply)
+{
+    _pvLength[ply] = ply;
+    if ((++_nodes & 2047) == 0) {
+        checkLimits();
+    }
+    if (stopped()) {
+        return 0;
+    }
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(position);
+    }
+
+    // in check every evasion is searched, otherwise the side to move may stand pat
+    bool inCheck = position.inCheck();
+    int bestScore = -INFINITE_SCORE;
+    int standPat = 0;
+    if (!inCheck) {
+        standPat = evaluate(position);
+        if (standPat >= beta) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+        bestScore = standPat;
+    }
+
+    // in check every evasion, otherwise only the captures that don't lose material
+    int scores[256];
+    MovePicker picker = inCheck
+        ? MovePicker(position, _moveLists[ply], scores, BitMove(), _killers[ply], BitMove(), _historyScores[position.sideToMove()])
+        : MovePicker(position, _moveLists[ply], scores);
+
+    for (BitMove move = picker.next(); !move.isNull(); move = picker.next()) {
+        // delta pruning: even winning this piece for free can't reach alpha
+        if (!inCheck && move.isCapture() && !move.isPromotion()) {
+            int victim = move.flags() == MoveEnPassant ? Pawn : Position::pieceType(position.pieceAt(move.to()));
+            if (standPat + pieceValues[victim] + 200 <= alpha) {
+                continue;
+            }
+        }
+
+        UndoState undo;
+        position.makeMove(move, undo);
+        int score = -quiescence(position, -beta, -alpha, ply + 1);
+        position.unmakeMove(move, undo);
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (score >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    // in check with no evasions
+    if (bestScore == -INFINITE_SCORE) {
+        return -MATE_SCORE + ply;
+    }
+    return bestScore;
+}
+
+bool ChessSearch::isDraw(const Position &position) const
+{
+    if (position.halfmoveClock() >= 100) {
+        return true;
+    }
+
+    // a single repetition inside the search is scored as the draw it would lead to.
+    // a null move isn't a real move, nothing before it repeats anything after it
+    uint64_t key = position.hash();
+    int oldest = std::max(_keysSinceNull, (int)_keys.size() - position.halfmoveClock());
+    for (int i = (int)_keys.size() - 4; i >= oldest; i -= 2) {
+        if (_keys[i] == key) {
+            return true;
+        }
+    }
+
+    // bare kings, or a king and one minor piece against a bare king
+    uint64_t heavy = position.pieces(W_PAWNS) | position.pieces(B_PAWNS) | position.pieces(W_ROOKS)
+                   | position.pieces(B_ROOKS) | position.pieces(W_QUEENS) | position.pieces(B_QUEENS);
+    return !heavy && popCount(position.occupancy()) <= 3;
+}
+
+void ChessSearch::checkLimits()
+{
+    _publishedNodes.store(_nodes, std::memory_order_relaxed);
+    if (_deadline.expired() || (_limits.maxNodes && _nodes >= _limits.maxNodes)) {
+        stop();
+    }
+}
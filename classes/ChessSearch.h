@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Position.h"
+#include "SearchCommon.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//
+// chess search
+// principal variation alpha-beta inside iterative deepening, a capture-only
+// quiescence search at the leaves, null move pruning and late move reductions.
+// moves come from a staged MovePicker, ordered by the table move, static
+// exchange, killers, countermoves and history.
+// positions are cached in a caller-owned transposition table so several
+// searches (or threads) can share one; the caller starts a new table
+// generation before each search. the search ends when it reaches the
+// depth, node or time limit, or when stop() is called from another thread,
+// and always answers with the best move of the last completed iteration
+//
+
+constexpr int MAX_PLY = 128;
+constexpr int MATE_SCORE = 32000;
+// anything beyond this is a forced mate, the distance is MATE_SCORE - score plies
+constexpr int MATE_IN_MAX_PLY = MATE_SCORE - MAX_PLY;
+constexpr int INFINITE_SCORE = MATE_SCORE + 1;
+
+struct SearchLimits {
+    int         maxDepth = MAX_PLY - 1;
+    int         moveTimeMs = 0;     // hard budget for this move, 0 for none
+    uint64_t    maxNodes = 0;       // 0 for none
+};
+
+struct SearchResult {
+    BitMove     bestMove;
+    int         score = 0;          // centipawns from the side to move's point of view
+    int         depth = 0;          // last completed iteration
+    uint64_t    nodes = 0;
+    int         elapsedMs = 0;
+    std::vector<BitMove> pv;
+    std::vector<uint64_t> threadNodes;  // per search thread, summed into nodes
+};
+
+class ChessSearch
+{
+public:
+    // threads searching together pass the same stop flag so one stop() ends them all
+    explicit ChessSearch(TranspositionTable &tt, std::atomic<bool> *sharedStop = nullptr);
+
+    // helper threads (index > 0) skip some iterations so they spread over different depths
+    void setThreadIndex(int index) { _threadIndex = index; }
+
+    // keys of the positions played before the root, oldest first, for repetition draws
+    void setHistory(const std::vector<uint64_t> &keys) { _history = keys; }
+
+    // called after every completed iteration, e.g. to print UCI info lines
+    void setIterationCallback(std::function<void(const SearchResult &)> callback) { _onIteration = std::move(callback); }
+
+    SearchResult search(const Position &root, const SearchLimits &limits);
+    void stop() { _stop->store(true, std::memory_order_relaxed); }
+    // safe to read from another thread while searching, refreshed every few thousand nodes
+    uint64_t nodes() const { return _publishedNodes.load(std::memory_order_relaxed); }
+
+    // static evaluation in centipawns from the side to move's point of view
+    static int evaluate(const Position &position);
+
+private:
+    int pvs(Position &position, int alpha, int beta, int depth, int ply, bool nullAllowed);
+    int quiescence(Position &position, int alpha, int beta, int ply);
+
+    bool isDraw(const Position &position) const;
+    void checkLimits();
+    bool stopped() const { return _stop->load(std::memory_order_relaxed); }
+
+    TranspositionTable &    _tt;
+    SearchLimits            _limits;
+    std::function<void(const SearchResult &)> _onIteration;
+    SearchDeadline          _deadline;
+    std::atomic<bool>       _ownStop;
+    std::atomic<bool> *     _stop;
+    int                     _threadIndex;
+    uint64_t                _nodes;
+    std::atomic<uint64_t>   _publishedNodes;
+
+    // keys of every position from the game start down to the current node's parent
+    std::vector<uint64_t>   _history;
+    std::vector<uint64_t>   _keys;
+    // _keys from here on were reached after the innermost null move, 0 outside one
+    int                     _keysSinceNull;
+
+    MoveList                _moveLists[MAX_PLY];
+    BitMove                 _pv[MAX_PLY][MAX_PLY];
+    int                     _pvLength[MAX_PLY];
+    BitMove                 _killers[MAX_PLY][2];
+    // quiet move that last refuted each [from][to] move
+    BitMove                 _counterMoves[64][64];
+    // the move made at each ply on the way to the current node, null for a null move
+    BitMove                 _playedMoves[MAX_PLY];
+    int                     _historyScores[2][64][64];
+    int                     _reductions[64][64];
+};
@@ -0,0 +1,116 @@
+#include "Epd.h"
+
+namespace {
+
+const char *whitespace = " \t\r\n";
+
+std::string trim(const std::string &s)
+{
+    size_t start = s.find_first_not_of(whitespace);
+    if (start == std::string::npos) {
+        return "";
+    }
+    return s.substr(start, s.find_last_not_of(whitespace) - start + 1);
+}
+
+}
+
+const std::string *EpdEntry::operation(const std::string &opcode) const
+{
+    for (const auto &op : operations) {
+        if (op.first == opcode) {
+            return &op.second;
+        }
+    }
+    return nullptr;
+}
+
+bool parseEPD(const std::string &line, EpdEntry &entry)
+{
+    entry.operations.clear();
+
+    // the four position fields
+    size_t pos = 0;
+    std::string fields;
+    for (int field = 0; field < 4; field++) {
+        size_t start = line.find_first_not_of(whitespace, pos);
+        if (start == std::string::npos) {
+            return false;
+        }
+        pos = line.find_first_of(whitespace, start);
+        if (pos == std::string::npos) {
+            pos = line.size();
+        }
+        fields += line.substr(start, pos - start) + ' ';
+    }
+
+    // plenty of files, perft suites among them, put full FEN clocks before the operations
+    std::string halfmove = "0";
+    std::string fullmove = "1";
+    size_t clocks = pos;
+    std::string numbers[2];
+    for (std::string &number : numbers) {
+        size_t start = line.find_first_not_of(whitespace, clocks);
+        if (start == std::string::npos || !isdigit((unsigned char)line[start])) {
+            break;
+        }
+        clocks = line.find_first_not_of("0123456789", start);
+        number = line.substr(start, (clocks == std::string::npos ? line.size() : clocks) - start);
+    }
+    if (!numbers[1].empty()) {
+        halfmove = numbers[0];
+        fullmove = numbers[1];
+        pos = clocks == std::string::npos ? line.size() : clocks;
+    }
+
+    // operations: opcode, operands, semicolon. quoted operands may hold semicolons
+    while (pos < line.size()) {
+        size_t start = line.find_first_not_of(whitespace, pos);
+        if (start == std::string::npos) {
+            break;
+        }
+        size_t end = start;
+        bool quoted = false;
+        while (end < line.size() && (quoted || line[end] != ';')) {
+            if (line[end] == '"') {
+                quoted = !quoted;
+            }
+            end++;
+        }
+        std::string op = trim(line.substr(start, end - start));
+        pos = end + 1;
+        if (op.empty()) {
+            continue;
+        }
+        size_t split = op.find_first_of(whitespace);
+        std::string opcode = op.substr(0, split);
+        std::string operand = split == std::string::npos ? "" : trim(op.substr(split));
+        if (opcode == "hmvc") {
+            halfmove = operand;
+        } else if (opcode == "fmvn") {
+            fullmove = operand;
+        }
+        entry.operations.emplace_back(std::move(opcode), std::move(operand));
+    }
+
+    return entry.position.setFEN(fields + halfmove + ' ' + fullmove);
+}
+
+size_t loadEPD(std::istream &in, std::vector<EpdEntry> &entries)
+{
+    size_t failures = 0;
+    std::string line;
+    EpdEntry entry;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(whitespace);
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        if (parseEPD(line, entry)) {
+            entries.push_back(entry);
+        } else {
+            failures++;
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Position.h"
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// extended position description reader
+// an EPD line is the first four FEN fields followed by semicolon terminated
+// operations, e.g.  <fen fields> bm Nf3; id "WAC.001";
+// hmvc and fmvn, when present, set the clocks. positions go straight into a
+// Position, nothing touches the GUI classes, so test suites and datasets load
+// at parsing speed
+//
+
+struct EpdEntry {
+    Position position;
+    std::vector<std::pair<std::string, std::string>> operations;    // opcode, operand text
+
+    // operand text of the first operation with this opcode, or nullptr
+    const std::string *operation(const std::string &opcode) const;
+};
+
+bool parseEPD(const std::string &line, EpdEntry &entry);
+
+// appends every parseable line, skipping blank lines and # comments.
+// returns the number of lines that failed to parse
+size_t loadEPD(std::istream &in, std::vector<EpdEntry> &entries);
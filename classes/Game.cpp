@@ -1,7 +1,6 @@
 #include "Game.h"
 #include "Bit.h"
 #include "BitHolder.h"
-#include "Turn.h"
 #include "../Application.h"
 
 Game::Game()
@@ -15,6 +14,9 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 0;
+	_gameOptions.AIMoveTimeMs = 0;
+	_gameOptions.AIThreads = 0;
 	_gameOptions.AIvsAI = false;
 
 	_table = nullptr;
@@ -32,11 +34,6 @@ Game::Game()
 
 Game::~Game()
 {
-	for (auto &_turn : _turns)
-	{
-		delete _turn;
-	}
-	_turns.clear();
 	for (auto &_player : _players)
 	{
 		delete _player;
@@ -52,6 +49,10 @@ Game::~Game()
 
 void Game::setNumberOfPlayers(unsigned int n)
 {
+	for (auto &_player : _players)
+	{
+		delete _player;
+	}
 	_players.clear();
 	for (unsigned int i = 1; i <= n; i++)
 	{
@@ -65,10 +66,6 @@ void Game::setNumberOfPlayers(unsigned int n)
 
 	_gameOptions.gameNumber = 0;
 	_gameOptions.numberOfPlayers = n;
-
-	Turn *turn = Turn::initStartOfGame(this);
-	_turns.clear();
-	_turns.push_back(turn);
 }
 
 void Game::setAIPlayer(unsigned int playerNumber)
@@ -80,26 +77,68 @@ void Game::setAIPlayer(unsigned int playerNumber)
 
 void Game::startGame()
 {
-	std::string startState = stateString();
-	Turn *turn = _turns.at(0);
-	turn->_boardState = startState;
-	turn->_gameNumber = _gameOptions.gameNumber;
+	_history.reset(historyState(), zobristKey());
 	_gameOptions.currentTurnNo = 0;
 }
 
 void Game::endTurn()
 {
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
-	Turn *turn = new Turn;
-	turn->_boardState = stateString();
-	turn->_date = (int)_gameOptions.currentTurnNo;
-	turn->_score = _gameOptions.score;
-	turn->_gameNumber = _gameOptions.gameNumber;
-	_turns.push_back(turn);
+	_history.push(historyState(), zobristKey(), _gameOptions.score);
 	ClassGame::EndOfTurn();
 }
 
+void Game::aiSearchBudget(int &maxDepth, int &moveTimeMs) const
+{
+	if (_gameOptions.AIDepthSearches > 0)
+	{
+		maxDepth = _gameOptions.AIDepthSearches;
+		moveTimeMs = 0;
+		return;
+	}
+	moveTimeMs = _gameOptions.AIMoveTimeMs > 0 ? _gameOptions.AIMoveTimeMs : defaultAIMoveTimeMs;
+	if (_gameOptions.AIMAXDepth > 0)
+	{
+		maxDepth = _gameOptions.AIMAXDepth;
+	}
+}
+
+bool Game::undoTurn()
+{
+	if (!_history.canUndo())
+	{
+		return false;
+	}
+	cancelAI();
+	setHistoryState(_history.undo());
+	_gameOptions.currentTurnNo = _history.current();
+	return true;
+}
+
+bool Game::redoTurn()
+{
+	if (!_history.canRedo())
+	{
+		return false;
+	}
+	cancelAI();
+	setHistoryState(_history.redo());
+	_gameOptions.currentTurnNo = _history.current();
+	return true;
+}
+
+bool Game::replayTurn(int ply)
+{
+	if (ply < 0 || ply >= _history.size())
+	{
+		return false;
+	}
+	cancelAI();
+	setHistoryState(_history.seek(ply));
+	_gameOptions.currentTurnNo = _history.current();
+	return true;
+}
+
 //
 // scan for mouse is temporarily in the actual game class
 // this will be moved to a higher up class when the squares have a heirarchy
@@ -172,44 +211,14 @@ void Game::findDropTarget(ImVec2 &pos)
 }
 
 //
-// draw the board and then the pieces
+// draw the board and then the pieces, one draw list batch for the whole grid
 // this will also go somewhere else when the heirarchy is set up
 //
 void Game::drawFrame()
 {
 	scanForMouse();
 
-	Grid* grid = getGrid();
-
-	// Paint squares
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		square->paintSprite();
-	});
-
-	// Paint stationary pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && !square->bit()->getPickedUp() && !square->bit()->getMoving())
-		{
-			square->bit()->paintSprite();
-		}
-	});
-
-	// Paint moving pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getMoving() && !square->bit()->getPickedUp())
-		{
-			square->bit()->update();
-			square->bit()->paintSprite();
-		}
-	});
-
-	// Paint picked up pieces
-	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		if (square->bit() && square->bit()->getPickedUp())
-		{
-			square->bit()->paintSprite();
-		}
-	});
+	_renderer.draw(*getGrid());
 }
 
 void Game::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
@@ -246,6 +255,40 @@ void Game::updateAI()
 {
 }
 
+bool Game::updateAIAsync()
+{
+	if (!_aiFuture.valid())
+	{
+		std::function<int()> job = makeAISearch();
+		if (!job)
+		{
+			updateAI();
+			return true;
+		}
+		_aiFuture = std::async(std::launch::async, std::move(job));
+		return false;
+	}
+	if (_aiFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return false;
+	}
+	applyAIMove(_aiFuture.get());
+	return true;
+}
+
+void Game::cancelAI()
+{
+	// keep asking, the job may not have reached its search yet when the first stop lands
+	while (_aiFuture.valid())
+	{
+		stopAISearch();
+		if (_aiFuture.wait_for(std::chrono::milliseconds(1)) == std::future_status::ready)
+		{
+			_aiFuture.get();
+		}
+	}
+}
+
 void Game::mouseDown(ImVec2 &location, Entity *entity)
 {
 	bool placing = false;
@@ -12,16 +12,18 @@
 #include <chrono>
 #include <ctime>
 #include <future>
+#include <functional>
 
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
 
 #include "Player.h"
-#include "Turn.h"
+#include "TurnHistory.h"
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Grid.h"
+#include "BoardRenderer.h"
 
 
 const int AI_PLAYER = 1;
@@ -39,8 +41,10 @@ struct GameOptions
 	int gameNumber;
 	unsigned int currentTurnNo;
 	int score;
-	int AIDepthSearches;
-	int AIMAXDepth;
+	int AIDepthSearches;	// fixed search depth, ignores the clock when set
+	int AIMAXDepth;			// deepest iteration a timed search may reach, 0 for no cap
+	int AIMoveTimeMs;		// per-move thinking budget, 0 for the game's default
+	int AIThreads;			// search threads for games that can use them, 0 for one per core
 	bool AIvsAI;
 };
 
@@ -58,6 +62,10 @@ public:
 
 	// end the current game turn
 	virtual void endTurn();
+	// step through the recorded positions, each loads the state there through setHistoryState
+	bool undoTurn();
+	bool redoTurn();
+	bool replayTurn(int ply);
 
 	// Should return true if it is legal for the given bit to be moved from its current holder.
 	// Default implementation always returns true.
@@ -95,11 +103,30 @@ public:
 	virtual void stopGame() = 0;
 	virtual bool gameHasAI();
 	virtual void updateAI();
+
+	// background ai, polled once per frame so a deep search never blocks the render loop.
+	// games that return a job from makeAISearch() think on a worker thread, the others
+	// fall back to calling updateAI() in place. returns true once a move has been played
+	bool updateAIAsync();
+	// stops a running search and waits for the worker, the move it found is dropped
+	void cancelAI();
+	bool isAIThinking() const { return _aiFuture.valid(); }
+	// the best move of the last completed iteration while thinking, -1 when there is none
+	virtual int bestAIMoveSoFar() { return -1; }
 	virtual void pieceTaken(Bit *bit){};
 
 	virtual std::string initialStateString() = 0;
 	virtual std::string stateString() = 0;
 	virtual void setStateString(const std::string &s) = 0;
+	// what the turn history records for a ply and loads back, the whole position
+	// the game needs to go on from there. games whose state string leaves out the
+	// side to move, castling or clocks add them here
+	virtual std::string historyState() { return stateString(); }
+	virtual void setHistoryState(const std::string &s) { setStateString(s); }
+
+	// 64-bit zobrist key for the current position, cheap to compare and to use as a table key
+	// games that don't hash return 0
+	virtual uint64_t zobristKey() { return 0; }
 
 	void setNumberOfPlayers(unsigned int playerCount);
 	void setAIPlayer(unsigned int playerNumber);
@@ -131,7 +158,8 @@ public:
 	Player *_winner;
 
 	std::vector<Player *> _players;
-	std::vector<Turn *> _turns;
+	// every position of the game, as per-turn deltas
+	TurnHistory _history;
 
 	std::string _lastMove;
 
@@ -151,4 +179,21 @@ protected:
 	BitHolder *_dropTarget;
 	BitHolder *_oldHolder;
 	bool _dragMoved;
+
+	BoardRenderer _renderer;
+
+	// snapshot whatever the search needs on the main thread and return the job that runs on
+	// the worker. the job must not touch the grid or bits, it returns a move for applyAIMove()
+	virtual std::function<int()> makeAISearch() { return nullptr; }
+	// the depth and move time the options ask a search for: a fixed depth with no clock,
+	// or the move time (defaultAIMoveTimeMs when unset) and the max depth when there is one.
+	// maxDepth keeps the search's own default otherwise
+	static constexpr int defaultAIMoveTimeMs = 1000;
+	void aiSearchBudget(int &maxDepth, int &moveTimeMs) const;
+	// main thread, plays the move the worker returned
+	virtual void applyAIMove(int move) {}
+	// asks a running job to return early with the best move it has
+	virtual void stopAISearch() {}
+
+	std::future<int> _aiFuture;
 };
@@ -1,42 +1,25 @@
 #include "Grid.h"
+#include <algorithm>
 
-Grid::Grid(int width, int height) : _width(width), _height(height)
+Grid::Grid(int width, int height) : _squares(width * height), _width(width), _height(height)
 {
-    // Initialize 2D vectors
-    _squares.resize(height);
-    _enabled.resize(height);
-
-    for (int y = 0; y < height; y++) {
-        _squares[y].resize(width);
-        _enabled[y].resize(width);
-
-        for (int x = 0; x < width; x++) {
-            _squares[y][x] = new ChessSquare();
-            _enabled[y][x] = true; // All squares enabled by default
-        }
-    }
-}
-
-Grid::~Grid()
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            delete _squares[y][x];
-        }
+    // All squares enabled by default
+    _enabled.assign((width * height + 63) / 64, ~0ull);
+    if ((width * height) % 64) {
+        _enabled.back() = (1ull << ((width * height) % 64)) - 1;
     }
 }
 
 ChessSquare* Grid::getSquare(int x, int y)
 {
     if (!isValid(x, y)) return nullptr;
-    return _squares[y][x];
+    return &_squares[y * _width + x];
 }
 
 ChessSquare* Grid::getSquareByIndex(int index)
 {
-    int x, y;
-    getCoordinates(index, x, y);
-    return getSquare(x, y);
+    if (index < 0 || index >= _width * _height) return nullptr;
+    return &_squares[index];
 }
 
 bool Grid::isValid(int x, int y) const
@@ -47,13 +30,16 @@ bool Grid::isValid(int x, int y) const
 bool Grid::isEnabled(int x, int y) const
 {
     if (!isValid(x, y)) return false;
-    return _enabled[y][x];
+    int index = getIndex(x, y);
+    return (_enabled[index / 64] >> (index % 64)) & 1;
 }
 
 void Grid::setEnabled(int x, int y, bool enabled)
 {
     if (isValid(x, y)) {
-        _enabled[y][x] = enabled;
+        int index = getIndex(x, y);
+        uint64_t bit = 1ull << (index % 64);
+        _enabled[index / 64] = enabled ? _enabled[index / 64] | bit : _enabled[index / 64] & ~bit;
     }
 }
 
@@ -149,27 +135,6 @@ bool Grid::areConnected(int fromX, int fromY, int toX, int toY)
     return false;
 }
 
-// Iterator support
-void Grid::forEachSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            func(_squares[y][x], x, y);
-        }
-    }
-}
-
-void Grid::forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                func(_squares[y][x], x, y);
-            }
-        }
-    }
-}
-
 // Initialize squares
 void Grid::initializeSquares(float squareSize, const char* spriteName)
 {
@@ -186,7 +151,7 @@ void Grid::initializeChessSquares(float squareSize, const char* spriteName)
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
             ImVec2 position(squareSize * x + squareSize/2, squareSize * (7-y) + squareSize/2);
-            _squares[y][x]->initHolder(position, spriteName, x, y);
+            _squares[y * _width + x].initHolder(position, spriteName, x, y);
         }
     }
 }
@@ -195,7 +160,7 @@ void Grid::initializeSquare(int x, int y, float squareSize, const char* spriteNa
 {
     if (isValid(x, y)) {
         ImVec2 position(squareSize * x + squareSize/2, squareSize * y + squareSize/2);
-        _squares[y][x]->initHolder(position, spriteName, x, y);
+        _squares[y * _width + x].initHolder(position, spriteName, x, y);
     }
 }
 
@@ -204,15 +169,13 @@ std::string Grid::getStateString() const
 {
     std::string state;
 
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                Bit* bit = _squares[y][x]->bit();
-                if (bit) {
-                    state += std::to_string(bit->gameTag());
-                } else {
-                    state += '0';
-                }
+    for (size_t word = 0; word < _enabled.size(); word++) {
+        for (uint64_t bits = _enabled[word]; bits; bits &= bits - 1) {
+            Bit* bit = _squares[word * 64 + bitScanForward(bits)].bit();
+            if (bit) {
+                state += std::to_string(bit->gameTag());
+            } else {
+                state += '0';
             }
         }
     }
@@ -224,17 +187,15 @@ void Grid::setStateString(const std::string& state)
 {
     size_t index = 0;
 
-    for (int y = 0; y < _height && index < state.length(); y++) {
-        for (int x = 0; x < _width && index < state.length(); x++) {
-            if (_enabled[y][x]) {
-                char pieceChar = state[index++];
+    forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
+        if (index < state.length()) {
+            index++;
 
-                // Clear existing piece
-                _squares[y][x]->destroyBit();
+            // Clear existing piece
+            square->destroyBit();
 
-                // This method just sets the state - games need to create their own pieces
-                // when loading from state string based on the piece type
-            }
+            // This method just sets the state - games need to create their own pieces
+            // when loading from state string based on the piece type
         }
-    }
-}
\ No newline at end of file
+    });
+}
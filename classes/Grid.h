@@ -1,16 +1,22 @@
 #pragma once
 
 #include "ChessSquare.h"
+#include "Bitboard.h"
 #include <vector>
 #include <unordered_map>
-#include <functional>
 #include <string>
 
+//
+// the squares live in one row-major array, index y * width + x, and which
+// of them are enabled is a bitmask over the same indices. the iterators are
+// templates so the callbacks inline, forEachEnabledSquare only visits the
+// set bits of the mask
+//
+
 class Grid
 {
 public:
     Grid(int width, int height);
-    ~Grid();
 
     // Basic access
     ChessSquare* getSquare(int x, int y);
@@ -49,9 +55,28 @@ public:
     std::vector<ChessSquare*> getConnectedSquares(int x, int y);
     bool areConnected(int fromX, int fromY, int toX, int toY);
 
-    // Iterator support
-    void forEachSquare(std::function<void(ChessSquare*, int x, int y)> func);
-    void forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func);
+    // Iterator support, func(ChessSquare*, int x, int y) row by row
+    template <typename Func>
+    void forEachSquare(Func &&func)
+    {
+        ChessSquare* square = _squares.data();
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++) {
+                func(square++, x, y);
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEachEnabledSquare(Func &&func)
+    {
+        for (size_t word = 0; word < _enabled.size(); word++) {
+            for (uint64_t bits = _enabled[word]; bits; bits &= bits - 1) {
+                int index = (int)(word * 64) + bitScanForward(bits);
+                func(&_squares[index], index % _width, index / _width);
+            }
+        }
+    }
 
     // Initialize squares with positions and sprites
     void initializeChessSquares(float squareSize, const char* spriteName);
@@ -63,8 +88,9 @@ public:
     void setStateString(const std::string& state);
 
 private:
-    std::vector<std::vector<ChessSquare*>> _squares;
-    std::vector<std::vector<bool>> _enabled;
+    std::vector<ChessSquare> _squares;
+    // square i is bit i % 64 of word i / 64
+    std::vector<uint64_t> _enabled;
     std::unordered_map<int, std::vector<int>> _connections;
     int _width;
     int _height;
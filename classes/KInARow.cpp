@@ -0,0 +1,154 @@
+#include "KInARow.h"
+
+KInARow::KInARow(int width, int height, int k) : Game(), _board(width, height, k), _tt(16), _search(_tt), _bestSoFar(-1)
+{
+    _search.setIterationCallback([this](const KInARowSearchResult &result) {
+        _bestSoFar.store(result.move, std::memory_order_relaxed);
+    });
+    _grid = new Grid(_board.width(), _board.height());
+}
+
+KInARow::~KInARow()
+{
+    cancelAI();
+    delete _grid;
+}
+
+//
+// make an X or an O
+//
+Bit* KInARow::PieceForPlayer(const int playerNumber)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(playerNumber == 1 ? "o.png" : "x.png");
+    bit->setOwner(getPlayerAt(playerNumber));
+    return bit;
+}
+
+void KInARow::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = _board.width();
+    _gameOptions.rowY = _board.height();
+    _grid->initializeSquares(80, "square.png");
+    _board = KInARowBoard(_board.width(), _board.height(), _board.k());
+    _tt.clear();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
+    startGame();
+}
+
+bool KInARow::actionForEmptyHolder(BitHolder &holder)
+{
+    if (holder.bit() || _board.winner() >= 0) {
+        return false;
+    }
+    int playerNumber = getCurrentPlayer()->playerNumber();
+    if (playerNumber != _board.sideToMove()) {
+        return false;
+    }
+    ChessSquare *square = static_cast<ChessSquare*>(&holder);
+    // only this move's lines are rechecked for a win
+    _board.play(square->getRow() * _board.width() + square->getColumn());
+
+    Bit *bit = PieceForPlayer(playerNumber);
+    bit->setPosition(holder.getPosition());
+    holder.setBit(bit);
+    endTurn();
+    return true;
+}
+
+bool KInARow::canBitMoveFrom(Bit &bit, BitHolder &src)
+{
+    // stones never move once placed
+    return false;
+}
+
+bool KInARow::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
+{
+    return false;
+}
+
+void KInARow::stopGame()
+{
+    cancelAI();
+    _grid->forEachSquare([](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+    });
+    _board = KInARowBoard(_board.width(), _board.height(), _board.k());
+}
+
+Player* KInARow::checkForWinner()
+{
+    return _board.winner() >= 0 ? getPlayerAt(_board.winner()) : nullptr;
+}
+
+bool KInARow::checkForDraw()
+{
+    return _board.winner() < 0 && _board.full();
+}
+
+//
+// state strings, one digit per cell: 0 empty, 1 and 2 the players
+//
+std::string KInARow::initialStateString()
+{
+    return std::string(_board.cellCount(), '0');
+}
+
+std::string KInARow::stateString()
+{
+    return _board.state();
+}
+
+void KInARow::setStateString(const std::string &s)
+{
+    if (!_board.setState(s)) return;
+
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+        int playerNumber = _board.at(y * _board.width() + x);
+        if (playerNumber >= 0) {
+            Bit *bit = PieceForPlayer(playerNumber);
+            bit->setPosition(square->getPosition());
+            square->setBit(bit);
+        }
+    });
+}
+
+uint64_t KInARow::zobristKey()
+{
+    return _board.hash();
+}
+
+void KInARow::updateAI()
+{
+    std::function<int()> job = makeAISearch();
+    if (job) {
+        applyAIMove(job());
+    }
+}
+
+std::function<int()> KInARow::makeAISearch()
+{
+    if (_board.winner() >= 0 || _board.full()) {
+        return nullptr;
+    }
+
+    KInARowSearchLimits limits;
+    aiSearchBudget(limits.maxDepth, limits.moveTimeMs);
+    _bestSoFar.store(-1, std::memory_order_relaxed);
+
+    return [this, board = _board, limits]() {
+        return _search.search(board, limits).move;
+    };
+}
+
+void KInARow::applyAIMove(int move)
+{
+    if (move < 0 || move >= _board.cellCount() || _board.at(move) >= 0) return;
+    actionForEmptyHolder(*_grid->getSquare(move % _board.width(), move / _board.width()));
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Game.h"
+#include "KInARowSearch.h"
+
+//
+// tic-tac-toe's rules on any board: players take turns placing a stone on an
+// empty cell and the first to get k in a row, column or diagonal wins.
+// 15 x 15 with k = 5 is free-style gomoku
+//
+
+class KInARow : public Game
+{
+public:
+    KInARow(int width = 15, int height = 15, int k = 5);
+    ~KInARow();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    std::string stateString() override;
+    void        setStateString(const std::string &s) override;
+    uint64_t    zobristKey() override;
+    bool        actionForEmptyHolder(BitHolder &holder) override;
+    bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
+    bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
+    void        stopGame() override;
+
+    void        updateAI() override;
+    bool        gameHasAI() override { return true; }
+    int         bestAIMoveSoFar() override { return _bestSoFar.load(std::memory_order_relaxed); }
+    Grid* getGrid() override { return _grid; }
+
+protected:
+    std::function<int()> makeAISearch() override;
+    void        applyAIMove(int move) override;
+    void        stopAISearch() override { _search.stop(); }
+
+private:
+    Bit *       PieceForPlayer(const int playerNumber);
+
+    Grid*       _grid;
+    // the stones and their line counts; the grid only mirrors them for drawing
+    KInARowBoard _board;
+    TranspositionTable _tt;
+    KInARowSearch _search;
+    // cell from the search's last completed iteration, written by the worker
+    std::atomic<int> _bestSoFar;
+};
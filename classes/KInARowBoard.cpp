@@ -0,0 +1,201 @@
+#include "KInARowBoard.h"
+#include <algorithm>
+
+KInARowBoard::KInARowBoard(int width, int height, int k)
+{
+    _width = std::clamp(width, 1, maxCells);
+    _height = std::clamp(height, 1, maxCells / _width);
+    _k = std::clamp(k, 1, std::max(_width, _height));
+
+    int cells = cellCount();
+    // every window start in each of the four line directions
+    std::vector<std::vector<int>> windowsByCell(cells);
+    const int directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+    for (const auto &direction : directions) {
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++) {
+                int endX = x + direction[0] * (_k - 1);
+                int endY = y + direction[1] * (_k - 1);
+                if (endX < 0 || endX >= _width || endY < 0 || endY >= _height) {
+                    continue;
+                }
+                int window = (int)_windowCounts.size();
+                _windowCounts.push_back({ 0, 0 });
+                for (int i = 0; i < _k; i++) {
+                    windowsByCell[(y + direction[1] * i) * _width + x + direction[0] * i].push_back(window);
+                }
+            }
+        }
+    }
+    _cellWindowStart.push_back(0);
+    for (const auto &windows : windowsByCell) {
+        _cellWindows.insert(_cellWindows.end(), windows.begin(), windows.end());
+        _cellWindowStart.push_back((int)_cellWindows.size());
+    }
+
+    // each stone more in an open window is worth eight times the last, up to maxLineWeight
+    _lineWeights.assign(_k + 1, 0);
+    for (int count = 1; count <= _k; count++) {
+        _lineWeights[count] = count == 1 ? 1 : std::min(_lineWeights[count - 1] * 8, maxLineWeight);
+    }
+
+    clear();
+}
+
+void KInARowBoard::clear()
+{
+    _cells.assign(cellCount(), -1);
+    _near.assign(cellCount(), 0);
+    std::fill(_windowCounts.begin(), _windowCounts.end(), std::array<uint16_t, 2>{ 0, 0 });
+    std::fill(std::begin(_candidates), std::end(_candidates), 0);
+    // with k = 1 every empty window is a line one stone from done
+    _openLines[0] = _openLines[1] = _k == 1 ? (int)_windowCounts.size() : 0;
+    _sideToMove = 0;
+    _moveCount = 0;
+    _winner = -1;
+    _score[0] = _score[1] = 0;
+    _hash = 0;
+}
+
+std::string KInARowBoard::state() const
+{
+    std::string s(cellCount(), '0');
+    for (int cell = 0; cell < cellCount(); cell++) {
+        if (_cells[cell] >= 0) {
+            s[cell] = (char)('1' + _cells[cell]);
+        }
+    }
+    return s;
+}
+
+// play() keeps every count right whatever order the stones go down in and
+// never refuses a move once there's a winner, so each stone is simply played
+// for its owner
+bool KInARowBoard::setState(const std::string &state)
+{
+    if ((int)state.length() != cellCount()) {
+        return false;
+    }
+    clear();
+    int stones[2] = { 0, 0 };
+    for (int cell = 0; cell < cellCount(); cell++) {
+        int player = state[cell] - '1';
+        if (player == 0 || player == 1) {
+            _sideToMove = player;
+            play(cell);
+            stones[player]++;
+        }
+    }
+    _sideToMove = stones[0] > stones[1] ? 1 : 0;
+    return true;
+}
+
+void KInARowBoard::play(int cell)
+{
+    int us = _sideToMove;
+    _cells[cell] = (int8_t)us;
+    _hash ^= Zobrist::boardKey(us, cell);
+    _moveCount++;
+
+    for (int i = _cellWindowStart[cell]; i < _cellWindowStart[cell + 1]; i++) {
+        auto &counts = _windowCounts[_cellWindows[i]];
+        int mine = counts[us];
+        int theirs = counts[us ^ 1];
+        _openLines[0] -= isOpenLine(counts, 0);
+        _openLines[1] -= isOpenLine(counts, 1);
+        if (!theirs) {
+            _score[us] += _lineWeights[mine + 1] - _lineWeights[mine];
+            // only the last move can complete a line
+            if (mine + 1 == _k) {
+                _winner = us;
+            }
+        } else if (!mine) {
+            // the window is dead for them now
+            _score[us ^ 1] -= _lineWeights[theirs];
+        }
+        counts[us]++;
+        _openLines[0] += isOpenLine(counts, 0);
+        _openLines[1] += isOpenLine(counts, 1);
+    }
+
+    int x = cell % _width;
+    int y = cell / _width;
+    for (int ny = std::max(0, y - 2); ny <= std::min(_height - 1, y + 2); ny++) {
+        for (int nx = std::max(0, x - 2); nx <= std::min(_width - 1, x + 2); nx++) {
+            int near = ny * _width + nx;
+            _near[near]++;
+            if (_cells[near] < 0) {
+                _candidates[near / 64] |= 1ULL << (near % 64);
+            }
+        }
+    }
+    _candidates[cell / 64] &= ~(1ULL << (cell % 64));
+    _sideToMove ^= 1;
+}
+
+void KInARowBoard::undo(int cell)
+{
+    int us = _cells[cell];
+    _cells[cell] = -1;
+    _hash ^= Zobrist::boardKey(us, cell);
+    _moveCount--;
+    _winner = -1;
+
+    for (int i = _cellWindowStart[cell]; i < _cellWindowStart[cell + 1]; i++) {
+        auto &counts = _windowCounts[_cellWindows[i]];
+        _openLines[0] -= isOpenLine(counts, 0);
+        _openLines[1] -= isOpenLine(counts, 1);
+        counts[us]--;
+        _openLines[0] += isOpenLine(counts, 0);
+        _openLines[1] += isOpenLine(counts, 1);
+        int mine = counts[us];
+        int theirs = counts[us ^ 1];
+        if (!theirs) {
+            _score[us] -= _lineWeights[mine + 1] - _lineWeights[mine];
+        } else if (!mine) {
+            _score[us ^ 1] += _lineWeights[theirs];
+        }
+    }
+
+    int x = cell % _width;
+    int y = cell / _width;
+    for (int ny = std::max(0, y - 2); ny <= std::min(_height - 1, y + 2); ny++) {
+        for (int nx = std::max(0, x - 2); nx <= std::min(_width - 1, x + 2); nx++) {
+            int near = ny * _width + nx;
+            // the cell itself is empty again, so it rejoins if anything is still near it
+            if (--_near[near] == 0) {
+                _candidates[near / 64] &= ~(1ULL << (near % 64));
+            } else if (_cells[near] < 0) {
+                _candidates[near / 64] |= 1ULL << (near % 64);
+            }
+        }
+    }
+    _sideToMove = us;
+}
+
+int64_t KInARowBoard::threat(int cell, int player) const
+{
+    int64_t score = 0;
+    for (int i = _cellWindowStart[cell]; i < _cellWindowStart[cell + 1]; i++) {
+        const auto &counts = _windowCounts[_cellWindows[i]];
+        int mine = counts[player];
+        int theirs = counts[player ^ 1];
+        if (!theirs) {
+            score += _lineWeights[mine + 1] - _lineWeights[mine];
+        } else if (!mine) {
+            score += _lineWeights[theirs];
+        }
+    }
+    return score;
+}
+
+bool KInARowBoard::wins(int cell, int player) const
+{
+    for (int i = _cellWindowStart[cell]; i < _cellWindowStart[cell + 1]; i++) {
+        const auto &counts = _windowCounts[_cellWindows[i]];
+        if (counts[player] == _k - 1 && !counts[player ^ 1]) {
+            return true;
+        }
+    }
+    return false;
+}
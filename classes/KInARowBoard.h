@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Zobrist.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// m,n,k game board: width x height cells, k in a row wins
+// every window of k cells along a row, column or diagonal keeps a count of
+// each player's stones in it, and every cell knows the windows through it.
+// a move only touches its own windows, at most 4k of them, so win detection
+// (a window reaching k), the lines each side is one stone from finishing and
+// the threat score used by the evaluation are all updated incrementally
+// instead of rescanning the board. so is the set of candidate cells, which the
+// search walks instead of the whole board
+//
+
+class KInARowBoard
+{
+public:
+    static constexpr int maxCells = Zobrist::kMaxBoardSquares;
+
+    // sizes are clamped so the board fits the zobrist table
+    KInARowBoard(int width = 15, int height = 15, int k = 5);
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+    int k() const { return _k; }
+    int cellCount() const { return _width * _height; }
+
+    // the player on a cell, -1 when it's empty
+    int at(int cell) const { return _cells[cell]; }
+    int sideToMove() const { return _sideToMove; }
+    int moveCount() const { return _moveCount; }
+    bool full() const { return _moveCount == cellCount(); }
+    // the player who completed a line, -1 while nobody has
+    int winner() const { return _winner; }
+    uint64_t hash() const { return _sideToMove ? _hash ^ Zobrist::keys.sideToMove : _hash; }
+
+    // places a stone for the side to move and hands the move over
+    void play(int cell);
+    // takes back the last move, which was on cell
+    void undo(int cell);
+
+    // one digit per cell: 0 empty, 1 and 2 the players
+    std::string state() const;
+    // places every stone of a state() string. the side to move follows from the
+    // stone counts and the winner from the completed windows. false on a wrong length
+    bool setState(const std::string &state);
+
+    // a window's weight stops growing here, so a whole board's windows can't overflow the scores
+    static constexpr int64_t maxLineWeight = int64_t(1) << 48;
+
+    // threat score of the side to move's open windows minus the other side's
+    int64_t evaluate() const { return _score[_sideToMove] - _score[_sideToMove ^ 1]; }
+    // what a stone for player on cell would add to its windows plus what it would take from the other side's
+    int64_t threat(int cell, int player) const;
+    // a stone for player on cell completes a line
+    bool wins(int cell, int player) const;
+    // empty and within two cells of a stone; the only moves worth searching
+    bool isCandidate(int cell) const { return (_candidates[cell / 64] >> (cell % 64)) & 1; }
+    // calls f(cell) for every candidate, in cell order
+    template <typename F>
+    void forEachCandidate(F f) const
+    {
+        for (int word = 0; word < candidateWords; word++) {
+            for (uint64_t bits = _candidates[word]; bits;) {
+                f(word * 64 + popLSB(bits));
+            }
+        }
+    }
+    // open windows holding k - 1 of player's stones: lines one stone from done
+    int openLines(int player) const { return _openLines[player]; }
+
+private:
+    static constexpr int candidateWords = maxCells / 64;
+
+    // empties the board, keeping its size and windows
+    void clear();
+    bool isOpenLine(const std::array<uint16_t, 2> &counts, int player) const { return counts[player] == _k - 1 && !counts[player ^ 1]; }
+
+    int _width;
+    int _height;
+    int _k;
+
+    std::vector<int8_t> _cells;
+    // stones within two cells
+    std::vector<uint8_t> _near;
+    // bit per cell, set while the cell is empty and near a stone
+    uint64_t _candidates[candidateWords];
+    // stones of each player in each window, k can be as long as a 256 cell row
+    std::vector<std::array<uint16_t, 2>> _windowCounts;
+    // windows through cell c are _cellWindows[_cellWindowStart[c] .. _cellWindowStart[c + 1])
+    std::vector<int> _cellWindows;
+    std::vector<int> _cellWindowStart;
+    // value of a window holding n stones of one player and none of the other
+    std::vector<int64_t> _lineWeights;
+
+    int _sideToMove;
+    int _moveCount;
+    int _winner;
+    int64_t _score[2];
+    int _openLines[2];
+    uint64_t _hash;
+};
@@ -0,0 +1,206 @@
+#include "KInARowSearch.h"
+#include <algorithm>
+
+namespace {
+
+using SearchScores::INFINITE_SCORE;
+using SearchScores::WIN_SCORE;
+// a completed line, sooner is better
+constexpr int WIN_IN_MAX_PLY = WIN_SCORE - 2 * KInARowBoard::maxCells;
+constexpr int maxPly = KInARowBoard::maxCells;
+
+constexpr int64_t orderTTMove = int64_t(1) << 60;
+
+// threat scores grow fast with k, keep them clear of the win scores
+int evaluate(const KInARowBoard &board)
+{
+    return (int)std::clamp<int64_t>(board.evaluate(), -WIN_IN_MAX_PLY + 1, WIN_IN_MAX_PLY - 1);
+}
+
+}
+
+KInARowSearch::KInARowSearch(TranspositionTable &tt) : _tt(tt), _stop(false), _nodes(0), _rootMove(-1)
+{
+}
+
+KInARowSearchResult KInARowSearch::search(const KInARowBoard &root, const KInARowSearchLimits &limits)
+{
+    _limits = limits;
+    _deadline.start(limits.moveTimeMs);
+    _stop.store(false, std::memory_order_relaxed);
+    _nodes = 0;
+    _tt.newSearch();
+
+    KInARowSearchResult result;
+    if (root.winner() >= 0 || root.full()) {
+        return result;
+    }
+    int cells[KInARowBoard::maxCells];
+    int count = generateMoves(root, cells, -1);
+    result.move = cells[0];
+    // a forced move needs no thought
+    if (count == 1) {
+        return result;
+    }
+
+    KInARowBoard board = root;
+    iterativeDeepening(std::clamp(limits.maxDepth, 1, maxPly - 1), WIN_IN_MAX_PLY, _deadline,
+        [&](int depth) { return alphaBeta(board, -INFINITE_SCORE, INFINITE_SCORE, depth, 0); },
+        [&]() { return stopped(); },
+        [&](int score, int depth) {
+            result.move = _rootMove;
+            result.score = score;
+            result.depth = depth;
+            result.nodes = _nodes;
+            result.elapsedMs = _deadline.elapsedMs();
+            if (_onIteration) {
+                _onIteration(result);
+            }
+        });
+
+    result.nodes = _nodes;
+    result.elapsedMs = _deadline.elapsedMs();
+    return result;
+}
+
+int KInARowSearch::alphaBeta(KInARowBoard &board, int alpha, int beta, int depth, int ply)
+{
+    if ((++_nodes & 4095) == 0 && _deadline.expired()) {
+        stop();
+    }
+    if (stopped()) {
+        return 0;
+    }
+    // only the move just played can have made a line
+    if (board.winner() >= 0) {
+        return -WIN_SCORE + ply;
+    }
+    if (board.full()) {
+        return 0;
+    }
+
+    int us = board.sideToMove();
+    if (depth <= 0 || ply >= maxPly - 1) {
+        // a line the side to move can finish is a win, not a score
+        if (board.openLines(us)) {
+            return WIN_SCORE - ply - 1;
+        }
+        return evaluate(board);
+    }
+
+    uint64_t key = board.hash();
+    TranspositionTable::Entry entry;
+    int ttCell = -1;
+    if (_tt.probe(key, entry)) {
+        ttCell = entry.move - 1;
+        int ttScore = scoreFromTT(entry.score, ply, WIN_IN_MAX_PLY);
+        if (ply > 0 && entry.depth >= depth
+            && (entry.bound == TranspositionTable::BOUND_EXACT
+                || (entry.bound == TranspositionTable::BOUND_LOWER && ttScore >= beta)
+                || (entry.bound == TranspositionTable::BOUND_UPPER && ttScore <= alpha))) {
+            return ttScore;
+        }
+    }
+
+    int cells[KInARowBoard::maxCells];
+    int count = generateMoves(board, cells, ttCell);
+
+    int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    int bestMove = cells[0];
+    for (int i = 0; i < count; i++) {
+        board.play(cells[i]);
+        int score;
+        if (i == 0) {
+            score = -alphaBeta(board, -beta, -alpha, depth - 1, ply + 1);
+        } else {
+            score = -alphaBeta(board, -alpha - 1, -alpha, depth - 1, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(board, -beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        board.undo(cells[i]);
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > best) {
+            best = score;
+            bestMove = cells[i];
+            if (ply == 0) {
+                _rootMove = bestMove;
+            }
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    TranspositionTable::Bound bound = best >= beta ? TranspositionTable::BOUND_LOWER
+        : best > originalAlpha ? TranspositionTable::BOUND_EXACT : TranspositionTable::BOUND_UPPER;
+    _tt.store(key, scoreToTT(best, ply, WIN_IN_MAX_PLY), depth, bound, (uint16_t)(bestMove + 1));
+    return best;
+}
+
+int KInARowSearch::generateMoves(const KInARowBoard &board, int *cells, int ttCell) const
+{
+    // nothing to be near yet, take the middle
+    if (!board.moveCount()) {
+        cells[0] = board.height() / 2 * board.width() + board.width() / 2;
+        return 1;
+    }
+
+    int us = board.sideToMove();
+    // a line the side to move can finish is the only move worth making
+    if (board.openLines(us)) {
+        int winning = -1;
+        board.forEachCandidate([&](int cell) {
+            if (winning < 0 && board.wins(cell, us)) {
+                winning = cell;
+            }
+        });
+        if (winning >= 0) {
+            cells[0] = winning;
+            return 1;
+        }
+    }
+
+    // once the other side threatens to finish a line only blocks are moves
+    bool mustBlock = board.openLines(us ^ 1) > 0;
+    int count = 0;
+    int64_t scores[KInARowBoard::maxCells];
+    board.forEachCandidate([&](int cell) {
+        if (mustBlock && !board.wins(cell, us ^ 1)) {
+            return;
+        }
+        int64_t score = board.threat(cell, us);
+        if (cell == ttCell) {
+            score += orderTTMove;
+        }
+        cells[count] = cell;
+        scores[count] = score;
+        count++;
+    });
+
+    // insertion sort, best threat first
+    for (int i = 1; i < count; i++) {
+        int cell = cells[i];
+        int64_t score = scores[i];
+        int j = i;
+        for (; j > 0 && scores[j - 1] < score; j--) {
+            cells[j] = cells[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        cells[j] = cell;
+        scores[j] = score;
+    }
+
+    // quiet nodes only look at the strongest few
+    if (!mustBlock) {
+        count = std::min(count, std::max(_limits.maxCandidates, 1));
+    }
+    return count;
+}
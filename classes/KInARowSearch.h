@@ -0,0 +1,58 @@
+#pragma once
+
+#include "KInARowBoard.h"
+#include "SearchCommon.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <functional>
+
+//
+// m,n,k search
+// principal variation alpha-beta inside iterative deepening with a
+// transposition table. only empty cells near a stone are moves, ordered by
+// the threat they make or block. threats also prune the tree: a side with a
+// line it can finish wins on the spot, and a side facing one may only block
+// it. like the othello search it runs on one thread and starts its own table
+// generation
+//
+
+struct KInARowSearchLimits {
+    int         maxDepth = 32;
+    int         moveTimeMs = 0;     // hard budget for this move, 0 for none
+    int         maxCandidates = 12; // best-ordered moves searched at a quiet node
+};
+
+struct KInARowSearchResult {
+    int         move = -1;          // cell, -1 when the game is over
+    int         score = 0;
+    int         depth = 0;          // last completed iteration
+    uint64_t    nodes = 0;
+    int         elapsedMs = 0;
+};
+
+class KInARowSearch
+{
+public:
+    explicit KInARowSearch(TranspositionTable &tt);
+
+    // called after every completed iteration
+    void setIterationCallback(std::function<void(const KInARowSearchResult &)> callback) { _onIteration = std::move(callback); }
+
+    KInARowSearchResult search(const KInARowBoard &root, const KInARowSearchLimits &limits);
+    void stop() { _stop.store(true, std::memory_order_relaxed); }
+
+private:
+    int alphaBeta(KInARowBoard &board, int alpha, int beta, int depth, int ply);
+    // fills cells with the moves worth trying, best first; a move that wins
+    // on the spot comes back alone
+    int generateMoves(const KInARowBoard &board, int *cells, int ttCell) const;
+    bool stopped() const { return _stop.load(std::memory_order_relaxed); }
+
+    TranspositionTable &    _tt;
+    KInARowSearchLimits     _limits;
+    std::function<void(const KInARowSearchResult &)> _onIteration;
+    SearchDeadline          _deadline;
+    std::atomic<bool>       _stop;
+    uint64_t                _nodes;
+    int                     _rootMove;
+};
@@ -0,0 +1,183 @@
+#include "MagicBitboards.h"
+#include <mutex>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+Magic RookMagics[64];
+Magic BishopMagics[64];
+
+uint64_t KnightAttacks[64];
+uint64_t KingAttacks[64];
+uint64_t PawnAttacks[2][64];
+uint64_t BetweenSquares[64][64];
+uint64_t LineSquares[64][64];
+
+namespace {
+
+// every square's attack sets live in one flat table per piece type
+// sizes are the sum of 2^bits(mask) over all 64 squares
+uint64_t rookTable[0x19000];
+uint64_t bishopTable[0x1480];
+
+// fancy magics for a shift of 64 - bits(mask), found offline with a sparse
+// xorshift64* search and verified collision-free against every occupancy subset
+constexpr uint64_t rookMagicNumbers[64] = {
+    0x0A80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+    0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+    0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+};
+
+constexpr uint64_t bishopMagicNumbers[64] = {
+    0x9060124418008010ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+    0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+    0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+    0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+    0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+};
+
+constexpr int rookDirections[4][2]   = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+constexpr int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+constexpr uint64_t rank1 = 0x00000000000000FFULL;
+constexpr uint64_t rank8 = 0xFF00000000000000ULL;
+constexpr uint64_t fileA = 0x0101010101010101ULL;
+constexpr uint64_t fileH = 0x8080808080808080ULL;
+
+inline int popCount(uint64_t bb) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (int)__popcnt64(bb);
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
+// slow reference ray walk, only used while building the tables
+uint64_t slidingAttacks(const int directions[4][2], int square, uint64_t occupancy) {
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int rank = square / 8 + directions[d][0];
+        int file = square % 8 + directions[d][1];
+        while (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+            uint64_t bit = 1ULL << (rank * 8 + file);
+            attacks |= bit;
+            if (occupancy & bit) {
+                break;
+            }
+            rank += directions[d][0];
+            file += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+void initSlider(Magic magics[], uint64_t table[], const uint64_t magicNumbers[64], const int directions[4][2]) {
+    uint64_t *next = table;
+
+    for (int square = 0; square < 64; square++) {
+        uint64_t rankMask = rank1 << (8 * (square / 8));
+        uint64_t fileMask = fileA << (square % 8);
+        uint64_t edges = ((rank1 | rank8) & ~rankMask) | ((fileA | fileH) & ~fileMask);
+
+        Magic &m = magics[square];
+        m.mask = slidingAttacks(directions, square, 0) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.magic = magicNumbers[square];
+        m.attacks = next;
+
+        // walk every subset of the mask (carry-rippler) and store its real attack set
+        uint64_t subset = 0;
+        do {
+            m.attacks[m.index(subset)] = slidingAttacks(directions, square, subset);
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        next += 1ULL << popCount(m.mask);
+    }
+}
+
+// sets every on-board square reached by one of the given (rank, file) steps
+uint64_t stepAttacks(int square, const int steps[][2], int count) {
+    uint64_t attacks = 0;
+    for (int i = 0; i < count; i++) {
+        int rank = square / 8 + steps[i][0];
+        int file = square % 8 + steps[i][1];
+        if (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+            attacks |= 1ULL << (rank * 8 + file);
+        }
+    }
+    return attacks;
+}
+
+void initSteppers() {
+    static const int knightSteps[8][2] = { {2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2} };
+    static const int kingSteps[8][2]   = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+    static const int whitePawnSteps[2][2] = { {1, -1}, {1, 1} };
+    static const int blackPawnSteps[2][2] = { {-1, -1}, {-1, 1} };
+
+    for (int square = 0; square < 64; square++) {
+        KnightAttacks[square] = stepAttacks(square, knightSteps, 8);
+        KingAttacks[square] = stepAttacks(square, kingSteps, 8);
+        PawnAttacks[0][square] = stepAttacks(square, whitePawnSteps, 2);
+        PawnAttacks[1][square] = stepAttacks(square, blackPawnSteps, 2);
+    }
+}
+
+// needs the slider tables, a line is the intersection of the two empty-board rays plus both ends
+void initLines() {
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            BetweenSquares[a][b] = 0;
+            LineSquares[a][b] = 0;
+            if (a == b) {
+                continue;
+            }
+            uint64_t ends = (1ULL << a) | (1ULL << b);
+            if (getRookAttacks(a, 0) & (1ULL << b)) {
+                LineSquares[a][b] = (getRookAttacks(a, 0) & getRookAttacks(b, 0)) | ends;
+                BetweenSquares[a][b] = getRookAttacks(a, 1ULL << b) & getRookAttacks(b, 1ULL << a);
+            } else if (getBishopAttacks(a, 0) & (1ULL << b)) {
+                LineSquares[a][b] = (getBishopAttacks(a, 0) & getBishopAttacks(b, 0)) | ends;
+                BetweenSquares[a][b] = getBishopAttacks(a, 1ULL << b) & getBishopAttacks(b, 1ULL << a);
+            }
+        }
+    }
+}
+
+std::once_flag magicsReady;
+
+}
+
+void initMagicBitboards()
+{
+    std::call_once(magicsReady, [] {
+        initSteppers();
+        initSlider(RookMagics, rookTable, rookMagicNumbers, rookDirections);
+        initSlider(BishopMagics, bishopTable, bishopMagicNumbers, bishopDirections);
+        initLines();
+    });
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(USE_PEXT) && (defined(__BMI2__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define MAGIC_USE_PEXT 1
+#endif
+
+//
+// precomputed attack tables
+// knight, king and pawn attacks are plain per-square lookups. rook and bishop
+// attacks are a single table lookup indexed by the relevant occupancy, hashed
+// with a "fancy" magic multiply or, when the CPU has BMI2 and USE_PEXT is
+// defined, extracted directly with pext
+//
+
+struct Magic {
+    uint64_t    mask;       // relevant occupancy for this square (board edges removed)
+    uint64_t    magic;      // magic multiplier (unused with pext)
+    uint64_t*   attacks;    // this square's slice of the shared attack table
+    int         shift;      // 64 - number of bits in mask
+
+    inline unsigned int index(uint64_t occupancy) const {
+#if defined(MAGIC_USE_PEXT)
+        return (unsigned int)_pext_u64(occupancy, mask);
+#else
+        return (unsigned int)(((occupancy & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic RookMagics[64];
+extern Magic BishopMagics[64];
+
+extern uint64_t KnightAttacks[64];
+extern uint64_t KingAttacks[64];
+extern uint64_t PawnAttacks[2][64];     // [color][square] squares a pawn of that color attacks
+
+// for two squares on a shared rank, file or diagonal: the squares strictly
+// between them, and the whole line through both. zero when not aligned
+extern uint64_t BetweenSquares[64][64];
+extern uint64_t LineSquares[64][64];
+
+// builds the tables, safe to call more than once
+void initMagicBitboards();
+
+inline uint64_t getRookAttacks(int square, uint64_t occupancy) {
+    const Magic &m = RookMagics[square];
+    return m.attacks[m.index(occupancy)];
+}
+
+inline uint64_t getBishopAttacks(int square, uint64_t occupancy) {
+    const Magic &m = BishopMagics[square];
+    return m.attacks[m.index(occupancy)];
+}
+
+inline uint64_t getQueenAttacks(int square, uint64_t occupancy) {
+    return getRookAttacks(square, occupancy) | getBishopAttacks(square, occupancy);
+}
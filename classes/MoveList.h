@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Bitboard.h"
+
+//
+// fixed-capacity move list that lives on the stack or inside its owner
+// no chess position has more than 218 legal moves, so 256 never overflows
+// and generating into it never touches the heap
+//
+
+class MoveList
+{
+public:
+    static constexpr int capacity = 256;
+
+    MoveList() : _size(0) { }
+
+    void clear() { _size = 0; }
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    void push_back(const BitMove &move) { _moves[_size++] = move; }
+    template <typename... Args>
+    void emplace_back(Args&&... args) { _moves[_size++] = BitMove(std::forward<Args>(args)...); }
+
+    BitMove &operator[](int index) { return _moves[index]; }
+    const BitMove &operator[](int index) const { return _moves[index]; }
+
+    BitMove *begin() { return _moves; }
+    BitMove *end() { return _moves + _size; }
+    const BitMove *begin() const { return _moves; }
+    const BitMove *end() const { return _moves + _size; }
+
+private:
+    BitMove _moves[capacity];
+    int     _size;
+};
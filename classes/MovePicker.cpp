@@ -0,0 +1,237 @@
+#include "MovePicker.h"
+#include <utility>
+
+namespace {
+
+const int seeValues[7] = { 0, 100, 320, 330, 500, 900, 0 };
+
+}
+
+// the swap algorithm: both sides keep taking on the square with their least
+// valuable attacker, and either may stop when going on would lose
+bool seeAtLeast(const Position &position, const BitMove &move, int threshold)
+{
+    // promotions, en passant and castling only come out even at best
+    if (move.isPromotion() || move.flags() == MoveEnPassant || move.flags() == MoveCastle) {
+        return threshold <= 0;
+    }
+
+    int from = move.from();
+    int to = move.to();
+    int victim = position.pieceAt(to);
+    // what the move wins if nothing takes back, then what's left if the mover is lost
+    int swap = (victim == NO_PIECE ? 0 : seeValues[Position::pieceType(victim)]) - threshold;
+    if (swap < 0) {
+        return false;
+    }
+    swap = seeValues[Position::pieceType(position.pieceAt(from))] - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    uint64_t queens = position.pieces(WHITE, Queen) | position.pieces(BLACK, Queen);
+    uint64_t bishops = position.pieces(WHITE, Bishop) | position.pieces(BLACK, Bishop) | queens;
+    uint64_t rooks = position.pieces(WHITE, Rook) | position.pieces(BLACK, Rook) | queens;
+    uint64_t occupied = position.occupancy() ^ (1ULL << from) ^ (1ULL << to);
+    uint64_t attackers = position.attackersTo(to, occupied);
+    int side = position.sideToMove();
+    bool result = true;
+
+    while (true) {
+        side ^= 1;
+        attackers &= occupied;
+        uint64_t sideAttackers = attackers & position.colorPieces(side);
+        if (!sideAttackers) {
+            break;
+        }
+        result = !result;
+
+        int piece = Pawn;
+        uint64_t attacker = 0;
+        for (; piece <= King; piece++) {
+            attacker = sideAttackers & position.pieces(side, (ChessPiece)piece);
+            if (attacker) {
+                break;
+            }
+        }
+        // the king may only take when nothing is left to take it back
+        if (piece == King) {
+            return (attackers & ~position.colorPieces(side)) ? !result : result;
+        }
+        swap = seeValues[piece] - swap;
+        if (swap < (int)result) {
+            break;
+        }
+
+        // taking uncovers any slider lined up behind the piece
+        occupied ^= 1ULL << bitScanForward(attacker);
+        if (piece == Pawn || piece == Bishop || piece == Queen) {
+            attackers |= getBishopAttacks(to, occupied) & bishops;
+        }
+        if (piece == Rook || piece == Queen) {
+            attackers |= getRookAttacks(to, occupied) & rooks;
+        }
+    }
+    return result;
+}
+
+MovePicker::MovePicker(const Position &position, MoveList &moves, int *scores, BitMove ttMove,
+                       const BitMove *killers, BitMove counterMove, const int (*history)[64])
+    : _position(position), _moves(moves), _scores(scores), _ttMove(ttMove), _killers{ killers[0], killers[1] },
+      _counterMove(counterMove), _history(history), _stage(StageTTMove), _current(0), _end(0), _badEnd(0)
+{
+}
+
+MovePicker::MovePicker(const Position &position, MoveList &moves, int *scores)
+    : _position(position), _moves(moves), _scores(scores), _history(nullptr), _stage(StageQuiescenceCaptures), _current(0), _end(0), _badEnd(0)
+{
+    generateCaptures();
+}
+
+BitMove MovePicker::next()
+{
+    switch (_stage) {
+    case StageTTMove:
+        _stage = StageGenerateCaptures;
+        if (!_ttMove.isNull() && _position.isLegal(_ttMove)) {
+            return _ttMove;
+        }
+        [[fallthrough]];
+
+    case StageGenerateCaptures:
+        generateCaptures();
+        _stage = StageGoodCaptures;
+        [[fallthrough]];
+
+    case StageGoodCaptures:
+        while (_current < _end) {
+            pickBest();
+            BitMove move = _moves[_current++];
+            if (move == _ttMove) {
+                continue;
+            }
+            // slots before _current are spent, so the losing ones can be kept there for later
+            if (isLosing(move)) {
+                _moves[_badEnd++] = move;
+                continue;
+            }
+            return move;
+        }
+        _stage = StageFirstKiller;
+        [[fallthrough]];
+
+    case StageFirstKiller:
+        _stage = StageSecondKiller;
+        if (playableRemembered(_killers[0])) {
+            return _killers[0];
+        }
+        [[fallthrough]];
+
+    case StageSecondKiller:
+        _stage = StageCounterMove;
+        if (playableRemembered(_killers[1])) {
+            return _killers[1];
+        }
+        [[fallthrough]];
+
+    case StageCounterMove:
+        _stage = StageGenerateQuiets;
+        if (_counterMove != _killers[0] && _counterMove != _killers[1] && playableRemembered(_counterMove)) {
+            return _counterMove;
+        }
+        [[fallthrough]];
+
+    case StageGenerateQuiets:
+        // the captures stay in front, the quiets go after them
+        _current = _moves.size();
+        _position.generateQuiets(_moves);
+        _end = _moves.size();
+        for (int i = _current; i < _end; i++) {
+            _scores[i] = _history[_moves[i].from()][_moves[i].to()];
+        }
+        _stage = StageQuiets;
+        [[fallthrough]];
+
+    case StageQuiets:
+        while (_current < _end) {
+            pickBest();
+            BitMove move = _moves[_current++];
+            if (!alreadyTried(move)) {
+                return move;
+            }
+        }
+        _current = 0;
+        _end = _badEnd;
+        _stage = StageBadCaptures;
+        [[fallthrough]];
+
+    case StageBadCaptures:
+        if (_current < _end) {
+            return _moves[_current++];
+        }
+        _stage = StageDone;
+        return BitMove();
+
+    case StageQuiescenceCaptures:
+        while (_current < _end) {
+            pickBest();
+            BitMove move = _moves[_current++];
+            if (!isLosing(move)) {
+                return move;
+            }
+        }
+        _stage = StageDone;
+        return BitMove();
+
+    default:
+        return BitMove();
+    }
+}
+
+// most valuable victim first, then least valuable attacker, promotions by the piece they make
+void MovePicker::generateCaptures()
+{
+    _moves.clear();
+    _position.generateCaptures(_moves);
+    _current = 0;
+    _end = _moves.size();
+    for (int i = 0; i < _end; i++) {
+        const BitMove &move = _moves[i];
+        int victim = move.flags() == MoveEnPassant ? Pawn
+            : move.isCapture() ? Position::pieceType(_position.pieceAt(move.to())) : NoPiece;
+        _scores[i] = seeValues[victim] * 16 - Position::pieceType(_position.pieceAt(move.from()));
+        if (move.isPromotion()) {
+            _scores[i] += seeValues[move.promotionPiece()];
+        }
+    }
+}
+
+void MovePicker::pickBest()
+{
+    int best = _current;
+    for (int i = _current + 1; i < _end; i++) {
+        if (_scores[i] > _scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(_moves[_current], _moves[best]);
+    std::swap(_scores[_current], _scores[best]);
+}
+
+bool MovePicker::isLosing(const BitMove &move) const
+{
+    if (move.isPromotion() && move.promotionPiece() != Queen) {
+        return true;
+    }
+    return !seeAtLeast(_position, move, 0);
+}
+
+bool MovePicker::alreadyTried(const BitMove &move) const
+{
+    return move == _ttMove || move == _killers[0] || move == _killers[1] || move == _counterMove;
+}
+
+bool MovePicker::playableRemembered(const BitMove &move) const
+{
+    return !move.isNull() && move != _ttMove && !move.isCapture() && !move.isPromotion() && _position.isLegal(move);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Position.h"
+
+//
+// staged move picker for the chess search
+// hands out a position's moves one at a time, in stages: the transposition
+// table move, captures that don't lose material by static exchange evaluation
+// (most valuable victim / least valuable attacker first), the two killers, the
+// countermove, the quiet moves by history score, and last the losing captures
+// and underpromotions. captures and quiets are generated separately the first
+// time a stage needs them, so a cutoff on an early move never generates the
+// quiet moves. remembered moves are checked with Position::isLegal() first
+//
+
+// whether the exchange move starts on its destination square gains at least
+// threshold centipawns for the side making it. pins are ignored
+bool seeAtLeast(const Position &position, const BitMove &move, int threshold);
+
+class MovePicker
+{
+public:
+    // every legal move. moves and scores are the ply's scratch space, killers its
+    // two killer slots and history the side to move's [from][to] scores
+    MovePicker(const Position &position, MoveList &moves, int *scores, BitMove ttMove,
+               const BitMove *killers, BitMove counterMove, const int (*history)[64]);
+    // quiescence: only captures and queen promotions that don't lose material
+    MovePicker(const Position &position, MoveList &moves, int *scores);
+
+    // the null move once there are no more
+    BitMove next();
+
+private:
+    enum Stage {
+        StageTTMove,
+        StageGenerateCaptures,
+        StageGoodCaptures,
+        StageFirstKiller,
+        StageSecondKiller,
+        StageCounterMove,
+        StageGenerateQuiets,
+        StageQuiets,
+        StageBadCaptures,
+        StageQuiescenceCaptures,
+        StageDone
+    };
+
+    void generateCaptures();
+    // swaps the best scored move in [_current, _end) into _current
+    void pickBest();
+    // captures that lose material, and underpromotions
+    bool isLosing(const BitMove &move) const;
+    // moves the earlier stages already handed out
+    bool alreadyTried(const BitMove &move) const;
+    // a remembered quiet move that is playable here and not handed out yet
+    bool playableRemembered(const BitMove &move) const;
+
+    const Position &    _position;
+    MoveList &          _moves;
+    int *               _scores;
+    BitMove             _ttMove;
+    BitMove             _killers[2];
+    BitMove             _counterMove;
+    const int         (*_history)[64];
+    int                 _stage;
+    // the stage's moves are [_current, _end). losing captures are
+    // set aside in [0, _badEnd) as the good capture stage passes them
+    int                 _current;
+    int                 _end;
+    int                 _badEnd;
+};
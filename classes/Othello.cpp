@@ -1,19 +1,16 @@
 #include "Othello.h"
 #include <iostream>
 
-// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
-const int Othello::DIRECTIONS[8][2] = {
-    {0, -1}, {1, -1}, {1, 0}, {1, 1},
-    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
-};
-
-Othello::Othello() : Game() {
+Othello::Othello() : Game(), _tt(16), _search(_tt), _bestSoFar(-1) {
+    _search.setIterationCallback([this](const OthelloSearchResult &result) {
+        _bestSoFar.store(result.move, std::memory_order_relaxed);
+    });
     _grid = new Grid(8, 8);
-    _consecutivePasses = 0;
     _showingHints = false;
 }
 
 Othello::~Othello() {
+    cancelAI();
     delete _grid;
 }
 
@@ -24,21 +21,10 @@ void Othello::setUpBoard() {
 
     _grid->initializeSquares(80, "boardsquare.png");
 
-    // Set up initial four pieces in the center
-    Player* blackPlayer = getPlayerAt(BLACK_PLAYER);
-    Player* whitePlayer = getPlayerAt(WHITE_PLAYER);
-
     // Standard Othello starting position
-    auto placePiece = [&](int x, int y, Player* player) {
-        Bit* piece = createPiece(player);
-        piece->setPosition(_grid->getSquare(x, y)->getPosition());
-        _grid->getSquare(x, y)->setBit(piece);
-    };
-
-    placePiece(3, 3, whitePlayer);  // White at (3,3)
-    placePiece(4, 4, whitePlayer);  // White at (4,4)
-    placePiece(4, 3, blackPlayer);  // Black at (4,3)
-    placePiece(3, 4, blackPlayer);  // Black at (3,4)
+    _board.reset();
+    syncBoardToGrid();
+    _tt.clear();
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
@@ -54,6 +40,20 @@ Bit* Othello::createPiece(Player* player) {
     return bit;
 }
 
+// rebuilds every disc, only for setup and loading states; moves update the grid in place
+void Othello::syncBoardToGrid() {
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+        for (int player = 0; player < 2; player++) {
+            if ((_board.discs(player) >> (y * 8 + x)) & 1) {
+                Bit* piece = createPiece(getPlayerAt(player));
+                piece->setPosition(square->getPosition());
+                square->setBit(piece);
+            }
+        }
+    });
+}
+
 bool Othello::actionForEmptyHolder(BitHolder &holder) {
     if (holder.bit()) return false;
 
@@ -61,31 +61,32 @@ bool Othello::actionForEmptyHolder(BitHolder &holder) {
     int x = square->getColumn();
     int y = square->getRow();
     Player* currentPlayer = getCurrentPlayer();
+    if (currentPlayer->playerNumber() != _board.sideToMove()) return false;
 
-    if (!isValidMove(x, y, currentPlayer)) return false;
+    uint64_t flipped = _board.play(y * 8 + x);
+    if (!flipped) return false;
 
     // Place the piece
     Bit* newPiece = createPiece(currentPlayer);
     newPiece->setPosition(holder.getPosition());
     holder.setBit(newPiece);
 
-    // Flip all affected pieces
-    flipPieces(x, y, currentPlayer);
-    _consecutivePasses = 0;
-
-    // Check if next player has moves
-    Player* nextPlayer = getPlayerAt(1 - currentPlayer->playerNumber());
-    if (!hasValidMove(nextPlayer)) {
-        _consecutivePasses++;
-        if (hasValidMove(currentPlayer)) {
-            // Next player passes, current player continues
-            return true;
-        } else {
-            _consecutivePasses = 2; // Game ends
+    // flipped discs keep their sprite and take the new disc's owner and texture
+    while (flipped) {
+        int flippedSquare = popLSB(flipped);
+        Bit* piece = _grid->getSquare(flippedSquare % 8, flippedSquare / 8)->bit();
+        if (piece) {
+            piece->setOwner(currentPlayer);
+            piece->setTexture(newPiece->getTexture());
         }
     }
 
     endTurn();
+    // Next player passes, current player continues. the pass is a ply of its own
+    if (!_board.legalMoves() && !_board.gameOver()) {
+        _board.pass();
+        endTurn();
+    }
     return true;
 }
 
@@ -97,156 +98,27 @@ bool Othello::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     return false; // Pieces cannot be moved in Othello
 }
 
-bool Othello::isValidMove(int x, int y, Player* player) const {
-    if (!_grid->isValid(x, y) || _grid->getSquare(x, y)->bit()) return false;
-
-    // Check if placing a piece here would flip at least one opponent piece
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player) > 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-int Othello::checkDirection(int x, int y, int dx, int dy, Player* player) const {
-    int count = 0;
-    int nx = x + dx;
-    int ny = y + dy;
-
-    if (!_grid->isValid(nx, ny)) return 0;
-
-    Bit* firstPiece = _grid->getSquare(nx, ny)->bit();
-    if (!firstPiece || firstPiece->getOwner() == player) return 0;
-
-    // Count opponent pieces in this direction
-    while (_grid->isValid(nx, ny)) {
-        Bit* piece = _grid->getSquare(nx, ny)->bit();
-        if (!piece) return 0;
-        if (piece->getOwner() == player) return count;
-        count++;
-        nx += dx;
-        ny += dy;
-    }
-    return 0;
-}
-
-void Othello::flipPieces(int x, int y, Player* player) {
-    for (int i = 0; i < 8; i++) {
-        int count = checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player);
-        if (count > 0) {
-            flipInDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player, count);
-        }
-    }
-}
-
-void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int count) {
-    int nx = x + dx;
-    int ny = y + dy;
-
-    for (int i = 0; i < count; i++) {
-        ChessSquare* square = _grid->getSquare(nx, ny);
-        if (square && square->bit()) {
-            square->destroyBit();
-            Bit* newPiece = createPiece(player);
-            newPiece->setPosition(square->getPosition());
-            square->setBit(newPiece);
-        }
-        nx += dx;
-        ny += dy;
-    }
-}
-
-bool Othello::hasValidMove(Player* player) const {
-    bool hasMove = false;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!hasMove && isValidMove(x, y, player)) {
-            hasMove = true;
-        }
-    });
-    return hasMove;
-}
-
-std::vector<std::pair<int, int>> Othello::getValidMoves(Player* player) const {
-    std::vector<std::pair<int, int>> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (isValidMove(x, y, player)) {
-            moves.push_back({x, y});
-        }
-    });
-    return moves;
-}
-
 Player* Othello::checkForWinner() {
-    // Game ends when neither player can move
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
-    // Check if board is full
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
+    // Game ends when neither player can move, a full board included
+    if (!_board.gameOver()) return nullptr;
 
+    int blackCount = _board.count(BLACK_PLAYER);
+    int whiteCount = _board.count(WHITE_PLAYER);
+    if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
+    if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
     return nullptr;
 }
 
 bool Othello::checkForDraw() {
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-    return false;
-}
-
-void Othello::countPieces(int &blackCount, int &whiteCount) const {
-    blackCount = 0;
-    whiteCount = 0;
-
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* piece = square->bit();
-        if (piece) {
-            if (piece->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-                blackCount++;
-            } else {
-                whiteCount++;
-            }
-        }
-    });
+    return _board.gameOver() && _board.count(BLACK_PLAYER) == _board.count(WHITE_PLAYER);
 }
 
 void Othello::stopGame() {
+    cancelAI();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-    _consecutivePasses = 0;
+    _board.reset();
 }
 
 std::string Othello::initialStateString() {
@@ -259,72 +131,79 @@ std::string Othello::initialStateString() {
 }
 
 std::string Othello::stateString() {
-    std::string state;
-    _grid->forEachSquare([&state, this](ChessSquare* square, int x, int y) {
-        Bit* bit = square->bit();
-        if (!bit) {
-            state += '0';
-        } else if (bit->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-            state += '1';
-        } else {
-            state += '2';
+    std::string state(64, '0');
+    for (int square = 0; square < 64; square++) {
+        if ((_board.discs(BLACK_PLAYER) >> square) & 1) {
+            state[square] = '1';
+        } else if ((_board.discs(WHITE_PLAYER) >> square) & 1) {
+            state[square] = '2';
         }
-    });
+    }
     return state;
 }
 
 void Othello::setStateString(const std::string &s) {
     if (s.length() != 64) return;
+    loadState(s, _board.sideToMove());
+}
 
-    int index = 0;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            char pieceType = s[index++];
-            square->destroyBit();
+std::string Othello::historyState() {
+    return stateString() + (char)('0' + _board.sideToMove());
+}
 
-            if (pieceType == '1') {
-                Bit* piece = createPiece(getPlayerAt(BLACK_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            } else if (pieceType == '2') {
-                Bit* piece = createPiece(getPlayerAt(WHITE_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            }
+void Othello::setHistoryState(const std::string &s) {
+    if (s.length() != 65) return;
+    loadState(s.substr(0, 64), s[64] == '1' ? WHITE_PLAYER : BLACK_PLAYER);
+}
+
+void Othello::loadState(const std::string &s, int sideToMove) {
+    uint64_t black = 0;
+    uint64_t white = 0;
+    for (int square = 0; square < 64; square++) {
+        if (s[square] == '1') {
+            black |= 1ULL << square;
+        } else if (s[square] == '2') {
+            white |= 1ULL << square;
         }
-    });
+    }
+    _board.set(black, white, sideToMove);
+    syncBoardToGrid();
+}
+
+uint64_t Othello::zobristKey() {
+    return _board.hash();
 }
 
 void Othello::updateAI() {
     if (!gameHasAI()) return;
 
-    Player* aiPlayer = getCurrentPlayer();
-    std::vector<std::pair<int, int>> validMoves = getValidMoves(aiPlayer);
-
-    if (validMoves.empty()) {
-        _consecutivePasses++;
+    std::function<int()> job = makeAISearch();
+    if (job) {
+        applyAIMove(job());
+    } else if (!_board.gameOver()) {
+        // nothing to play, pass the turn over
+        _board.pass();
         endTurn();
-        return;
     }
+}
 
-    // Find move that flips the most pieces
-    int bestX = -1, bestY = -1, maxFlips = 0;
-
-    for (const auto& move : validMoves) {
-        int x = move.first, y = move.second, totalFlips = 0;
-        for (int i = 0; i < 8; i++) {
-            totalFlips += checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], aiPlayer);
-        }
-        if (totalFlips > maxFlips) {
-            maxFlips = totalFlips;
-            bestX = x;
-            bestY = y;
-        }
+std::function<int()> Othello::makeAISearch() {
+    if (!_board.legalMoves()) {
+        return nullptr;
     }
 
-    if (bestX >= 0 && bestY >= 0) {
-        actionForEmptyHolder(*_grid->getSquare(bestX, bestY));
-    }
+    OthelloSearchLimits limits;
+    aiSearchBudget(limits.maxDepth, limits.moveTimeMs);
+    _bestSoFar.store(-1, std::memory_order_relaxed);
+
+    return [this, board = _board, limits]() {
+        return _search.search(board, limits).move;
+    };
+}
+
+void Othello::applyAIMove(int move) {
+    if (move < 0 || !_board.isLegal(move)) return;
+    actionForEmptyHolder(*_grid->getSquare(move % 8, move / 8));
 }
 
 void Othello::getBoardPosition(BitHolder& holder, int &x, int &y) const {
@@ -1,6 +1,6 @@
 #pragma once
 #include "Game.h"
-#include <vector>
+#include "OthelloSearch.h"
 
 // NOTE: This implementation assumes black.png and white.png exist in resources.
 // If not, you can use o.png and x.png, or any other suitable graphics.
@@ -18,6 +18,10 @@ public:
     std::string initialStateString() override;
     std::string stateString() override;
     void        setStateString(const std::string &s) override;
+    // the state string and the side to move, which a pass doesn't show on the board
+    std::string historyState() override;
+    void        setHistoryState(const std::string &s) override;
+    uint64_t    zobristKey() override;
     bool        actionForEmptyHolder(BitHolder &holder) override;
     bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
@@ -26,35 +30,39 @@ public:
     // AI methods
     void        updateAI() override;
     bool        gameHasAI() override { return true; } // Set to true when AI is implemented
+    int         bestAIMoveSoFar() override { return _bestSoFar.load(std::memory_order_relaxed); }
     Grid* getGrid() override { return _grid; }
 
+protected:
+    std::function<int()> makeAISearch() override;
+    void        applyAIMove(int move) override;
+    void        stopAISearch() override { _search.stop(); }
+
 private:
     // Player constants
-    static const int BLACK_PLAYER = 0;
-    static const int WHITE_PLAYER = 1;
-
-    // Direction vectors for checking all 8 directions
-    static const int DIRECTIONS[8][2];
+    static const int BLACK_PLAYER = OthelloBoard::BLACK_PLAYER;
+    static const int WHITE_PLAYER = OthelloBoard::WHITE_PLAYER;
 
     // Helper methods
     Bit*        createPiece(Player* player);
-    bool        isValidMove(int x, int y, Player* player) const;
-    int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
-    void        flipPieces(int x, int y, Player* player);
-    void        flipInDirection(int x, int y, int dx, int dy, Player* player, int count);
-    bool        hasValidMove(Player* player) const;
-    void        countPieces(int &blackCount, int &whiteCount) const;
-    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
+    // recreates the grid's discs from the bitboards
+    void        syncBoardToGrid();
+    // sets up the discs of a 64 character state string
+    void        loadState(const std::string &s, int sideToMove);
     void        showValidMoves(Player* player);
     void        clearValidMoveIndicators();
 
     // Board position helper
     void        getBoardPosition(BitHolder& holder, int &x, int &y) const;
 
-    // Board representation
+    // Board representation, the grid only mirrors _board for drawing
     Grid*       _grid;
+    OthelloBoard _board;
+    TranspositionTable _tt;
+    OthelloSearch _search;
+    // square from the search's last completed iteration, written by the worker
+    std::atomic<int> _bestSoFar;
 
     // Game state
-    int         _consecutivePasses;
     bool        _showingHints;
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "OthelloBoard.h"
+
+void OthelloBoard::reset()
+{
+    // d4 and e5 white, e4 and d5 black
+    set((1ULL << (4 * 8 + 3)) | (1ULL << (3 * 8 + 4)), (1ULL << (3 * 8 + 3)) | (1ULL << (4 * 8 + 4)), BLACK_PLAYER);
+}
+
+void OthelloBoard::set(uint64_t black, uint64_t white, int sideToMove)
+{
+    _discs[BLACK_PLAYER] = black;
+    _discs[WHITE_PLAYER] = white & ~black;
+    _sideToMove = sideToMove;
+    _hash = 0;
+    for (int player = 0; player < 2; player++) {
+        for (uint64_t bits = _discs[player]; bits;) {
+            _hash ^= Zobrist::boardKey(player, popLSB(bits));
+        }
+    }
+}
+
+bool OthelloBoard::gameOver() const
+{
+    return !legalMoves(_discs[0], _discs[1]) && !legalMoves(_discs[1], _discs[0]);
+}
+
+uint64_t OthelloBoard::play(int square)
+{
+    int us = _sideToMove;
+    uint64_t move = 1ULL << square;
+    if (!(empty() & move)) {
+        return 0;
+    }
+    uint64_t flipped = flips(_discs[us], _discs[us ^ 1], square);
+    if (!flipped) {
+        return 0;
+    }
+
+    _discs[us] |= move | flipped;
+    _discs[us ^ 1] &= ~flipped;
+    _hash ^= Zobrist::boardKey(us, square);
+    // a flipped disc changes color, both players' keys toggle
+    for (uint64_t bits = flipped; bits;) {
+        int flippedSquare = popLSB(bits);
+        _hash ^= Zobrist::boardKey(0, flippedSquare) ^ Zobrist::boardKey(1, flippedSquare);
+    }
+    _sideToMove ^= 1;
+    return flipped;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Zobrist.h"
+
+//
+// othello position as two bitboards
+// square index is y * 8 + x, the same layout the grid uses. legal moves and
+// flips come from shifted fills of the mover's discs through the opponent's in
+// all eight directions, so a move costs a few dozen word operations whatever
+// the board looks like. the board is a small value type; searches copy it
+// instead of undoing moves
+//
+
+class OthelloBoard
+{
+public:
+    static constexpr int BLACK_PLAYER = 0;
+    static constexpr int WHITE_PLAYER = 1;
+
+    // the standard four disc start, black to move
+    OthelloBoard() { reset(); }
+
+    void reset();
+    void set(uint64_t black, uint64_t white, int sideToMove);
+
+    uint64_t discs(int player) const { return _discs[player]; }
+    uint64_t empty() const { return ~(_discs[0] | _discs[1]); }
+    int sideToMove() const { return _sideToMove; }
+    int count(int player) const { return popCount(_discs[player]); }
+    int emptyCount() const { return popCount(empty()); }
+    uint64_t hash() const { return _sideToMove ? _hash ^ Zobrist::keys.sideToMove : _hash; }
+
+    // squares the side to move can play
+    uint64_t legalMoves() const { return legalMoves(_discs[_sideToMove], _discs[_sideToMove ^ 1]); }
+    bool isLegal(int square) const { return (legalMoves() >> square) & 1; }
+    // neither side can move
+    bool gameOver() const;
+
+    // places a disc for the side to move, flips and hands the move over.
+    // returns the flipped discs, nothing happens for an illegal square
+    uint64_t play(int square);
+    // the side to move has no legal move
+    void pass() { _sideToMove ^= 1; }
+
+    static uint64_t legalMoves(uint64_t player, uint64_t opponent);
+    // discs a move on square would flip, 0 if it flips nothing
+    static uint64_t flips(uint64_t player, uint64_t opponent, int square);
+
+private:
+    uint64_t    _discs[2];
+    int         _sideToMove;
+    uint64_t    _hash;
+};
+
+namespace OthelloBits {
+
+// opponent discs that can sit inside a horizontal or diagonal run; edge discs
+// are left out so shifts by 1, 7 and 9 never carry a run across the board edge
+constexpr uint64_t notEdgeFiles = 0x7E7E7E7E7E7E7E7EULL;
+
+template <int S>
+inline uint64_t shift(uint64_t b) { return S > 0 ? b << S : b >> -S; }
+
+// kogge-stone occluded fill: gen plus every square reached by walking from it
+// through pro in direction S
+template <int S>
+inline uint64_t fill(uint64_t gen, uint64_t pro)
+{
+    gen |= pro & shift<S>(gen);
+    pro &= shift<S>(pro);
+    gen |= pro & shift<2 * S>(gen);
+    pro &= shift<2 * S>(pro);
+    gen |= pro & shift<4 * S>(gen);
+    return gen;
+}
+
+template <int S>
+inline uint64_t movesInDirection(uint64_t player, uint64_t opponent, uint64_t empty)
+{
+    uint64_t run = fill<S>(player, opponent) & opponent;
+    return shift<S>(run) & empty;
+}
+
+template <int S>
+inline uint64_t flipsInDirection(uint64_t move, uint64_t player, uint64_t opponent)
+{
+    uint64_t run = fill<S>(move, opponent) & opponent;
+    return (shift<S>(run) & player) ? run : 0;
+}
+
+}
+
+inline uint64_t OthelloBoard::legalMoves(uint64_t player, uint64_t opponent)
+{
+    using namespace OthelloBits;
+    uint64_t empty = ~(player | opponent);
+    uint64_t inner = opponent & notEdgeFiles;
+    return movesInDirection<1>(player, inner, empty) | movesInDirection<-1>(player, inner, empty)
+        | movesInDirection<8>(player, opponent, empty) | movesInDirection<-8>(player, opponent, empty)
+        | movesInDirection<7>(player, inner, empty) | movesInDirection<-7>(player, inner, empty)
+        | movesInDirection<9>(player, inner, empty) | movesInDirection<-9>(player, inner, empty);
+}
+
+inline uint64_t OthelloBoard::flips(uint64_t player, uint64_t opponent, int square)
+{
+    using namespace OthelloBits;
+    uint64_t move = 1ULL << square;
+    uint64_t inner = opponent & notEdgeFiles;
+    return flipsInDirection<1>(move, player, inner) | flipsInDirection<-1>(move, player, inner)
+        | flipsInDirection<8>(move, player, opponent) | flipsInDirection<-8>(move, player, opponent)
+        | flipsInDirection<7>(move, player, inner) | flipsInDirection<-7>(move, player, inner)
+        | flipsInDirection<9>(move, player, inner) | flipsInDirection<-9>(move, player, inner);
+}
@@ -0,0 +1,444 @@
+#include "OthelloSearch.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int INFINITE_SCORE = 32000;
+// a won or lost game beats any evaluation, the disc difference breaks ties
+constexpr int WIN_SCORE = 10000;
+constexpr int maxMoves = 64;
+
+// below this many empties the solver drops the table and move ordering
+constexpr int shallowEmpties = 6;
+
+// endgame entries hold disc differences, keep them apart from midgame scores
+constexpr uint64_t solveKey = 0x9E3779B97F4A7C15ULL;
+
+constexpr uint64_t cornerMask = 0x8100000000000081ULL;
+constexpr uint64_t notAFile = 0xFEFEFEFEFEFEFEFEULL;
+constexpr uint64_t notHFile = 0x7F7F7F7F7F7F7F7FULL;
+constexpr uint64_t edgeRanks = 0xFF000000000000FFULL;
+constexpr uint64_t edgeFiles = 0x8181818181818181ULL;
+const uint64_t quadrants[4] = { 0x000000000F0F0F0FULL, 0x00000000F0F0F0F0ULL, 0x0F0F0F0F00000000ULL, 0xF0F0F0F000000000ULL };
+
+// the x square diagonal to each corner and the two c squares beside it, a1 h1 a8 h8
+const int corners[4] = { 0, 7, 56, 63 };
+const int xSquares[4] = { 9, 14, 49, 54 };
+const uint64_t cSquares[4] = { 0x0000000000000102ULL, 0x0000000000008040ULL, 0x0201000000000000ULL, 0x4080000000000000ULL };
+
+constexpr int mobilityWeight = 12;
+constexpr int frontierWeight = 4;
+constexpr int cornerWeight = 90;
+constexpr int xSquareWeight = 40;
+constexpr int cSquareWeight = 15;
+constexpr int stableWeight = 25;
+
+// move ordering before the table and mobility say anything, corners first and x squares last
+const int squareOrder[64] = {
+    100, -20,  10,   5,   5,  10, -20, 100,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+     10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+      5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+      5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+     10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+    100, -20,  10,   5,   5,  10, -20, 100
+};
+
+constexpr int orderTTMove = 1 << 20;
+
+uint64_t neighbours(uint64_t b)
+{
+    return (b << 8) | (b >> 8)
+        | (((b << 1) | (b << 9) | (b >> 7)) & notAFile)
+        | (((b >> 1) | (b >> 9) | (b << 7)) & notHFile);
+}
+
+// discs in an unbroken line along an edge from a corner of their own color, none can ever flip
+uint64_t stableEdgeDiscs(uint64_t own)
+{
+    uint64_t stable = own & cornerMask;
+    uint64_t grown = stable;
+    while (grown) {
+        uint64_t next = ((((stable << 1) & notAFile) | ((stable >> 1) & notHFile)) & edgeRanks)
+            | (((stable << 8) | (stable >> 8)) & edgeFiles);
+        grown = next & own & ~stable;
+        stable |= grown;
+    }
+    return stable;
+}
+
+// final disc difference, the winner takes the empty squares
+int finalScore(uint64_t player, uint64_t opponent)
+{
+    int diff = popCount(player) - popCount(opponent);
+    int empties = 64 - popCount(player | opponent);
+    return diff > 0 ? diff + empties : diff < 0 ? diff - empties : 0;
+}
+
+int terminalScore(uint64_t player, uint64_t opponent)
+{
+    int diff = finalScore(player, opponent);
+    return diff > 0 ? WIN_SCORE + diff : diff < 0 ? -WIN_SCORE + diff : 0;
+}
+
+// squares in quadrants with an odd number of empties, the last move of a region goes there
+uint64_t oddRegions(uint64_t empty)
+{
+    uint64_t odd = 0;
+    for (uint64_t quadrant : quadrants) {
+        if (popCount(empty & quadrant) & 1) {
+            odd |= quadrant;
+        }
+    }
+    return odd;
+}
+
+}
+
+OthelloSearch::OthelloSearch(TranspositionTable &tt) : _tt(tt), _stop(false), _nodes(0), _rootMove(-1)
+{
+}
+
+int OthelloSearch::evaluate(const OthelloBoard &board)
+{
+    int us = board.sideToMove();
+    uint64_t player = board.discs(us);
+    uint64_t opponent = board.discs(us ^ 1);
+    uint64_t empty = board.empty();
+
+    int score = mobilityWeight * (popCount(OthelloBoard::legalMoves(player, opponent)) - popCount(OthelloBoard::legalMoves(opponent, player)));
+
+    // discs next to empties give the opponent moves
+    uint64_t frontier = neighbours(empty);
+    score -= frontierWeight * (popCount(player & frontier) - popCount(opponent & frontier));
+
+    score += stableWeight * (popCount(stableEdgeDiscs(player)) - popCount(stableEdgeDiscs(opponent)));
+
+    for (int i = 0; i < 4; i++) {
+        uint64_t corner = 1ULL << corners[i];
+        if (player & corner) {
+            score += cornerWeight;
+        } else if (opponent & corner) {
+            score -= cornerWeight;
+        } else {
+            // squares next to an empty corner hand it over
+            uint64_t x = 1ULL << xSquares[i];
+            score -= xSquareWeight * (((player & x) != 0) - ((opponent & x) != 0));
+            score -= cSquareWeight * (popCount(player & cSquares[i]) - popCount(opponent & cSquares[i]));
+        }
+    }
+    return std::clamp(score, -WIN_SCORE + 1, WIN_SCORE - 1);
+}
+
+OthelloSearchResult OthelloSearch::search(const OthelloBoard &root, const OthelloSearchLimits &limits)
+{
+    _limits = limits;
+    _deadline.start(limits.moveTimeMs);
+    _stop.store(false, std::memory_order_relaxed);
+    _nodes = 0;
+    _tt.newSearch();
+
+    OthelloSearchResult result;
+    uint64_t moves = root.legalMoves();
+    if (!moves) {
+        return result;
+    }
+    result.move = bitScanForward(moves);
+
+    auto publish = [&](int score, int depth, bool exact) {
+        if (_rootMove >= 0) {
+            result.move = _rootMove;
+        }
+        result.score = score;
+        result.depth = depth;
+        result.exact = exact;
+        result.nodes = _nodes;
+        result.elapsedMs = _deadline.elapsedMs();
+        if (_onIteration) {
+            _onIteration(result);
+        }
+    };
+
+    int empties = root.emptyCount();
+    bool solving = empties <= _limits.exactEmpties;
+    // solving still wants a move in hand in case the clock runs out first
+    int maxDepth = std::clamp(solving ? std::min(_limits.maxDepth, 4) : _limits.maxDepth, 1, empties);
+
+    int score = 0;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        _rootMove = -1;
+        int guess = mtdf(root, score, depth, false);
+        if (stopped()) {
+            break;
+        }
+        score = guess;
+        publish(score, depth, false);
+
+        if (!_deadline.roomForIteration()) {
+            break;
+        }
+    }
+
+    if (solving && !stopped()) {
+        _rootMove = -1;
+        int exact = mtdf(root, 0, empties, true);
+        if (!stopped()) {
+            publish(exact, empties, true);
+        }
+    }
+
+    result.nodes = _nodes;
+    result.elapsedMs = _deadline.elapsedMs();
+    return result;
+}
+
+int OthelloSearch::mtdf(const OthelloBoard &board, int guess, int depth, bool exact)
+{
+    int lower = -INFINITE_SCORE;
+    int upper = INFINITE_SCORE;
+    int score = guess;
+    while (lower < upper) {
+        int beta = score == lower ? score + 1 : score;
+        score = rootSearch(board, beta, depth, exact);
+        if (stopped()) {
+            break;
+        }
+        if (score < beta) {
+            upper = score;
+        } else {
+            lower = score;
+        }
+    }
+    return score;
+}
+
+int OthelloSearch::rootSearch(const OthelloBoard &board, int beta, int depth, bool exact)
+{
+    uint64_t key = exact ? board.hash() ^ solveKey : board.hash();
+    TranspositionTable::Entry entry;
+    int ttMove = _tt.probe(key, entry) ? entry.move - 1 : -1;
+
+    int order[maxMoves];
+    int count = orderMoves(board, board.legalMoves(), ttMove, exact, order);
+
+    int best = -INFINITE_SCORE;
+    int bestMove = order[0];
+    for (int i = 0; i < count; i++) {
+        OthelloBoard child = board;
+        child.play(order[i]);
+        int score = exact ? -solve(child, 1 - beta, false) : -alphaBeta(child, 1 - beta, depth - 1, false);
+        if (stopped()) {
+            return best;
+        }
+        if (score > best) {
+            best = score;
+            bestMove = order[i];
+            if (best >= beta) {
+                _rootMove = bestMove;
+                break;
+            }
+        }
+    }
+
+    _tt.store(key, best, exact ? 64 : depth, best >= beta ? TranspositionTable::BOUND_LOWER : TranspositionTable::BOUND_UPPER, (uint16_t)(bestMove + 1));
+    return best;
+}
+
+// null window around beta, fail soft
+int OthelloSearch::alphaBeta(const OthelloBoard &board, int beta, int depth, bool passed)
+{
+    if ((++_nodes & 4095) == 0 && _deadline.expired()) {
+        stop();
+    }
+    if (stopped()) {
+        return 0;
+    }
+
+    int us = board.sideToMove();
+    uint64_t player = board.discs(us);
+    uint64_t opponent = board.discs(us ^ 1);
+    uint64_t moves = OthelloBoard::legalMoves(player, opponent);
+    if (!moves) {
+        if (passed) {
+            return terminalScore(player, opponent);
+        }
+        OthelloBoard child = board;
+        child.pass();
+        return -alphaBeta(child, 1 - beta, depth, true);
+    }
+    if (depth <= 0) {
+        return evaluate(board);
+    }
+
+    uint64_t key = board.hash();
+    TranspositionTable::Entry entry;
+    int ttMove = -1;
+    if (_tt.probe(key, entry)) {
+        if (entry.depth >= depth) {
+            if (entry.bound == TranspositionTable::BOUND_EXACT
+                || (entry.bound == TranspositionTable::BOUND_LOWER && entry.score >= beta)
+                || (entry.bound == TranspositionTable::BOUND_UPPER && entry.score < beta)) {
+                return entry.score;
+            }
+        }
+        ttMove = entry.move - 1;
+    }
+
+    int order[maxMoves];
+    int count = orderMoves(board, moves, ttMove, false, order);
+
+    int best = -INFINITE_SCORE;
+    int bestMove = order[0];
+    for (int i = 0; i < count; i++) {
+        OthelloBoard child = board;
+        child.play(order[i]);
+        int score = -alphaBeta(child, 1 - beta, depth - 1, false);
+        if (stopped()) {
+            return 0;
+        }
+        if (score > best) {
+            best = score;
+            bestMove = order[i];
+            if (best >= beta) {
+                break;
+            }
+        }
+    }
+
+    _tt.store(key, best, depth, best >= beta ? TranspositionTable::BOUND_LOWER : TranspositionTable::BOUND_UPPER, (uint16_t)(bestMove + 1));
+    return best;
+}
+
+// exact disc difference with a null window around beta, fail soft
+int OthelloSearch::solve(const OthelloBoard &board, int beta, bool passed)
+{
+    int us = board.sideToMove();
+    uint64_t player = board.discs(us);
+    uint64_t opponent = board.discs(us ^ 1);
+    if (board.emptyCount() <= shallowEmpties) {
+        return solveShallow(player, opponent, beta, passed);
+    }
+
+    if ((++_nodes & 4095) == 0 && _deadline.expired()) {
+        stop();
+    }
+    if (stopped()) {
+        return 0;
+    }
+
+    uint64_t moves = OthelloBoard::legalMoves(player, opponent);
+    if (!moves) {
+        if (passed) {
+            return finalScore(player, opponent);
+        }
+        OthelloBoard child = board;
+        child.pass();
+        return -solve(child, 1 - beta, true);
+    }
+
+    uint64_t key = board.hash() ^ solveKey;
+    TranspositionTable::Entry entry;
+    int ttMove = -1;
+    if (_tt.probe(key, entry)) {
+        if ((entry.bound == TranspositionTable::BOUND_LOWER && entry.score >= beta)
+            || (entry.bound == TranspositionTable::BOUND_UPPER && entry.score < beta)) {
+            return entry.score;
+        }
+        ttMove = entry.move - 1;
+    }
+
+    int order[maxMoves];
+    int count = orderMoves(board, moves, ttMove, true, order);
+
+    int best = -INFINITE_SCORE;
+    int bestMove = order[0];
+    for (int i = 0; i < count; i++) {
+        OthelloBoard child = board;
+        child.play(order[i]);
+        int score = -solve(child, 1 - beta, false);
+        if (stopped()) {
+            return 0;
+        }
+        if (score > best) {
+            best = score;
+            bestMove = order[i];
+            if (best >= beta) {
+                break;
+            }
+        }
+    }
+
+    _tt.store(key, best, board.emptyCount(), best >= beta ? TranspositionTable::BOUND_LOWER : TranspositionTable::BOUND_UPPER, (uint16_t)(bestMove + 1));
+    return best;
+}
+
+// odd regions first, which usually gets the last move of each region
+int OthelloSearch::solveShallow(uint64_t player, uint64_t opponent, int beta, bool passed)
+{
+    _nodes++;
+
+    uint64_t moves = OthelloBoard::legalMoves(player, opponent);
+    if (!moves) {
+        if (passed) {
+            return finalScore(player, opponent);
+        }
+        return -solveShallow(opponent, player, 1 - beta, true);
+    }
+
+    uint64_t odd = oddRegions(~(player | opponent));
+    uint64_t passes[2] = { moves & odd, moves & ~odd };
+    int best = -INFINITE_SCORE;
+    for (uint64_t squares : passes) {
+        while (squares) {
+            int square = popLSB(squares);
+            uint64_t flipped = OthelloBoard::flips(player, opponent, square);
+            int score = -solveShallow(opponent & ~flipped, player | flipped | (1ULL << square), 1 - beta, false);
+            if (score > best) {
+                best = score;
+                if (best >= beta) {
+                    return best;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// fewest replies for the opponent first; the solver adds parity, the midgame the square table
+int OthelloSearch::orderMoves(const OthelloBoard &board, uint64_t moves, int ttMove, bool exact, int *out) const
+{
+    int us = board.sideToMove();
+    uint64_t player = board.discs(us);
+    uint64_t opponent = board.discs(us ^ 1);
+    uint64_t odd = exact ? oddRegions(board.empty()) : 0;
+
+    int scores[maxMoves];
+    int count = 0;
+    while (moves) {
+        int square = popLSB(moves);
+        uint64_t flipped = OthelloBoard::flips(player, opponent, square);
+        int replies = popCount(OthelloBoard::legalMoves(opponent & ~flipped, player | flipped | (1ULL << square)));
+
+        int score = -replies * 16;
+        if (square == ttMove) {
+            score += orderTTMove;
+        } else if (exact) {
+            score += ((odd >> square) & 1) ? 8 : 0;
+            score += ((cornerMask >> square) & 1) ? 32 : 0;
+        } else {
+            score += squareOrder[square];
+        }
+
+        // insertion sort, there are never many moves
+        int i = count++;
+        while (i > 0 && scores[i - 1] < score) {
+            scores[i] = scores[i - 1];
+            out[i] = out[i - 1];
+            i--;
+        }
+        scores[i] = score;
+        out[i] = square;
+    }
+    return count;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "OthelloBoard.h"
+#include "SearchCommon.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <functional>
+
+//
+// othello search
+// midgame positions are searched with MTD(f): iterative deepening where every
+// iteration converges on the score through null-window alpha-beta calls, each
+// one cheap because the transposition table remembers the last. the leaves
+// are scored on mobility, corners, edge stability and frontier discs.
+// with few enough empties the game is solved outright on the final disc
+// count, ordering moves by region parity and by the opponent's replies.
+// unlike the chess search there is one thread, so search() starts the table
+// generation itself
+//
+
+struct OthelloSearchLimits {
+    int         maxDepth = 60;
+    int         moveTimeMs = 0;     // hard budget for this move, 0 for none
+    int         exactEmpties = 18;  // solve the endgame exactly from this many empties
+};
+
+struct OthelloSearchResult {
+    int         move = -1;          // square index, -1 when the side to move must pass
+    int         score = 0;          // evaluation, or the final disc difference when exact
+    int         depth = 0;          // last completed iteration
+    bool        exact = false;      // the score is the solved result of the game
+    uint64_t    nodes = 0;
+    int         elapsedMs = 0;
+};
+
+class OthelloSearch
+{
+public:
+    explicit OthelloSearch(TranspositionTable &tt);
+
+    // called after every completed iteration and after a finished solve
+    void setIterationCallback(std::function<void(const OthelloSearchResult &)> callback) { _onIteration = std::move(callback); }
+
+    OthelloSearchResult search(const OthelloBoard &root, const OthelloSearchLimits &limits);
+    void stop() { _stop.store(true, std::memory_order_relaxed); }
+
+    // static evaluation from the side to move's point of view
+    static int evaluate(const OthelloBoard &board);
+
+private:
+    // one null-window pass at the root, sets _rootMove when it fails high
+    int rootSearch(const OthelloBoard &board, int beta, int depth, bool exact);
+    int alphaBeta(const OthelloBoard &board, int beta, int depth, bool passed);
+    int solve(const OthelloBoard &board, int beta, bool passed);
+    // no table or ordering, for the last few empties
+    int solveShallow(uint64_t player, uint64_t opponent, int beta, bool passed);
+    int mtdf(const OthelloBoard &board, int guess, int depth, bool exact);
+
+    // fills moves/count best first
+    int orderMoves(const OthelloBoard &board, uint64_t moves, int ttMove, bool exact, int *out) const;
+    bool stopped() const { return _stop.load(std::memory_order_relaxed); }
+
+    TranspositionTable &    _tt;
+    OthelloSearchLimits     _limits;
+    std::function<void(const OthelloSearchResult &)> _onIteration;
+    SearchDeadline          _deadline;
+    std::atomic<bool>       _stop;
+    uint64_t                _nodes;
+    int                     _rootMove;
+};
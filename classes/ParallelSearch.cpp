@@ -0,0 +1,74 @@
+#include "ParallelSearch.h"
+#include <thread>
+
+ParallelSearch::ParallelSearch(TranspositionTable &tt, int threads) : _tt(tt), _stop(false)
+{
+    setThreads(threads);
+}
+
+void ParallelSearch::setThreads(int threads)
+{
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _workers.resize(threads);
+    for (int i = 0; i < threads; i++) {
+        if (!_workers[i]) {
+            _workers[i] = std::make_unique<ChessSearch>(_tt, &_stop);
+            _workers[i]->setThreadIndex(i);
+            _workers[i]->setHistory(_history);
+        }
+    }
+}
+
+void ParallelSearch::setHistory(const std::vector<uint64_t> &keys)
+{
+    _history = keys;
+    for (auto &worker : _workers) {
+        worker->setHistory(keys);
+    }
+}
+
+SearchResult ParallelSearch::search(const Position &root, const SearchLimits &limits)
+{
+    _stop.store(false, std::memory_order_relaxed);
+    _tt.newSearch();
+
+    // helpers run until the main thread is done, whatever depth or time it was given
+    SearchLimits helperLimits;
+    helperLimits.maxDepth = limits.maxDepth;
+
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < _workers.size(); i++) {
+        helpers.emplace_back([this, i, &root, &helperLimits] {
+            _workers[i]->search(root, helperLimits);
+        });
+    }
+
+    ChessSearch &main = *_workers[0];
+    main.setIterationCallback([this](const SearchResult &iteration) {
+        if (_onIteration) {
+            SearchResult result = iteration;
+            collectNodes(result);
+            _onIteration(result);
+        }
+    });
+    SearchResult result = main.search(root, limits);
+
+    stop();
+    for (std::thread &helper : helpers) {
+        helper.join();
+    }
+    collectNodes(result);
+    return result;
+}
+
+void ParallelSearch::collectNodes(SearchResult &result) const
+{
+    result.threadNodes.clear();
+    result.nodes = 0;
+    for (const auto &worker : _workers) {
+        result.threadNodes.push_back(worker->nodes());
+        result.nodes += worker->nodes();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ChessSearch.h"
+#include <memory>
+
+//
+// lazy smp chess search
+// every thread runs its own ChessSearch on a copy of the root position and
+// they cooperate only through the shared transposition table. the helpers skip
+// iterations in staggered patterns so they run ahead at different depths and
+// leave entries the main thread then finds. the main thread owns the clock and
+// the answer; when it finishes the helpers are stopped through the shared flag
+//
+
+class ParallelSearch
+{
+public:
+    // threads <= 0 uses every hardware thread
+    ParallelSearch(TranspositionTable &tt, int threads = 1);
+
+    // threads added later start with the history already set
+    void setThreads(int threads);
+    int threads() const { return (int)_workers.size(); }
+
+    void setHistory(const std::vector<uint64_t> &keys);
+    // called on the main thread's completed iterations, with node counts for all threads
+    void setIterationCallback(std::function<void(const SearchResult &)> callback) { _onIteration = std::move(callback); }
+
+    SearchResult search(const Position &root, const SearchLimits &limits);
+    void stop() { _stop.store(true, std::memory_order_relaxed); }
+
+private:
+    void collectNodes(SearchResult &result) const;
+
+    TranspositionTable &    _tt;
+    std::atomic<bool>       _stop;
+    std::vector<std::unique_ptr<ChessSearch>> _workers;
+    std::vector<uint64_t>   _history;
+    std::function<void(const SearchResult &)> _onIteration;
+};
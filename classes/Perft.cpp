@@ -0,0 +1,340 @@
+#include "Perft.h"
+#include "TurnHistory.h"
+#include <cstring>
+#include <vector>
+
+uint64_t perft(Position &position, int depth, bool bulk)
+{
+    if (depth == 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    if (bulk && depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    for (const BitMove &move : moves) {
+        UndoState undo;
+        position.makeMove(move, undo);
+        nodes += perft(position, depth - 1, bulk);
+        position.unmakeMove(move, undo);
+    }
+    return nodes;
+}
+
+uint64_t perftDivide(Position &position, int depth, bool bulk, std::ostream &out)
+{
+    if (depth < 1) {
+        return 1;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+
+    uint64_t nodes = 0;
+    for (const BitMove &move : moves) {
+        UndoState undo;
+        position.makeMove(move, undo);
+        uint64_t count = perft(position, depth - 1, bulk);
+        position.unmakeMove(move, undo);
+        out << moveToUCI(move) << ": " << count << "\n";
+        nodes += count;
+    }
+    return nodes;
+}
+
+uint64_t perftVerifyCodec(Position &position, int depth)
+{
+    uint64_t mismatches = 0;
+
+    std::string fen = position.fen();
+    Position fromFEN;
+    if (!fromFEN.setFEN(fen) || fromFEN.fen() != fen || fromFEN.hash() != position.hash()) {
+        mismatches++;
+    }
+
+    PackedPosition packed;
+    Position fromPacked;
+    if (!position.pack(packed) || !fromPacked.unpack(packed) || fromPacked.fen() != fen || fromPacked.hash() != position.hash()) {
+        mismatches++;
+    }
+
+    if (depth == 0) {
+        return mismatches;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    for (const BitMove &move : moves) {
+        UndoState undo;
+        position.makeMove(move, undo);
+        mismatches += perftVerifyCodec(position, depth - 1);
+        position.unmakeMove(move, undo);
+    }
+    return mismatches;
+}
+
+uint64_t perftVerifyStages(Position &position, int depth)
+{
+    MoveList moves;
+    MoveList captures;
+    MoveList quiets;
+    position.generateLegalMoves(moves);
+    position.generateCaptures(captures);
+    position.generateQuiets(quiets);
+
+    std::vector<uint8_t> legal(1 << 16, 0);
+    for (const BitMove &move : moves) {
+        legal[move.raw()] = 1;
+    }
+
+    bool ok = captures.size() + quiets.size() == moves.size();
+    for (const BitMove &move : captures) {
+        ok &= legal[move.raw()] && (move.isCapture() || move.isPromotion());
+    }
+    for (const BitMove &move : quiets) {
+        ok &= legal[move.raw()] && !move.isCapture() && !move.isPromotion();
+    }
+    uint64_t ours = position.colorPieces(position.sideToMove());
+    while (ours && ok) {
+        int from = popLSB(ours);
+        for (int to = 0; to < 64; to++) {
+            for (int flags = 0; flags < 16; flags++) {
+                BitMove move(from, to, flags);
+                ok &= position.isLegal(move) == (legal[move.raw()] != 0);
+            }
+        }
+    }
+
+    uint64_t mismatches = ok ? 0 : 1;
+    if (depth == 0) {
+        return mismatches;
+    }
+    for (const BitMove &move : moves) {
+        UndoState undo;
+        position.makeMove(move, undo);
+        mismatches += perftVerifyStages(position, depth - 1);
+        position.unmakeMove(move, undo);
+    }
+    return mismatches;
+}
+
+uint64_t perftVerifyHash(Position &position, int depth)
+{
+    uint64_t mismatches = position.hash() != position.computeHash() ? 1 : 0;
+    if (depth == 0) {
+        return mismatches;
+    }
+
+    MoveList moves;
+    position.generateLegalMoves(moves);
+    uint64_t before = position.hash();
+    for (const BitMove &move : moves) {
+        UndoState undo;
+        position.makeMove(move, undo);
+        mismatches += perftVerifyHash(position, depth - 1);
+        position.unmakeMove(move, undo);
+        if (position.hash() != before) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+namespace {
+
+std::string packedState(const Position &position)
+{
+    PackedPosition packed;
+    position.pack(packed);
+    return std::string(reinterpret_cast<const char *>(packed.bytes), sizeof(packed.bytes));
+}
+
+bool stateMatches(const std::string &state, const std::string &fen, uint64_t hash)
+{
+    PackedPosition packed;
+    Position position;
+    if (state.size() != sizeof(packed.bytes)) {
+        return false;
+    }
+    memcpy(packed.bytes, state.data(), sizeof(packed.bytes));
+    return position.unpack(packed) && position.fen() == fen && position.hash() == hash;
+}
+
+}
+
+uint64_t verifyTurnHistory(Position &position, int plies)
+{
+    TurnHistory history;
+    std::vector<std::string> fens{ position.fen() };
+    std::vector<uint64_t> hashes{ position.hash() };
+    history.reset(packedState(position), position.hash());
+
+    uint32_t seed = 12345;
+    for (int ply = 0; ply < plies; ply++) {
+        MoveList moves;
+        position.generateLegalMoves(moves);
+        if (moves.empty()) {
+            break;
+        }
+        seed = seed * 1103515245u + 12345u;
+        UndoState undo;
+        position.makeMove(moves[(seed >> 16) % moves.size()], undo);
+        history.push(packedState(position), position.hash());
+        fens.push_back(position.fen());
+        hashes.push_back(position.hash());
+    }
+
+    uint64_t mismatches = 0;
+    auto check = [&](const std::string &state) {
+        int ply = history.current();
+        if (!stateMatches(state, fens[ply], hashes[ply]) || history.hashAt(ply) != hashes[ply]) {
+            mismatches++;
+        }
+    };
+    while (history.canUndo()) {
+        check(history.undo());
+    }
+    while (history.canRedo()) {
+        check(history.redo());
+    }
+    for (int i = 0; i < history.size(); i++) {
+        check(history.seek((i * 37) % history.size()));
+        int ply = (i * 11) % history.size();
+        if (!stateMatches(history.stateAt(ply), fens[ply], hashes[ply])) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+namespace {
+
+bool sameCandidates(const KInARowBoard &a, const KInARowBoard &b)
+{
+    for (int cell = 0; cell < a.cellCount(); cell++) {
+        if (a.isCandidate(cell) != b.isCandidate(cell)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool boardMatches(const std::string &state, const KInARowBoard &expected)
+{
+    KInARowBoard board(expected.width(), expected.height(), expected.k());
+    return board.setState(state) && board.state() == expected.state() && board.hash() == expected.hash()
+        && board.winner() == expected.winner() && board.sideToMove() == expected.sideToMove()
+        && board.evaluate() == expected.evaluate()
+        && board.openLines(0) == expected.openLines(0) && board.openLines(1) == expected.openLines(1)
+        && sameCandidates(board, expected);
+}
+
+}
+
+uint64_t verifyKInARowHistory(int width, int height, int k)
+{
+    KInARowBoard board(width, height, k);
+    TurnHistory history;
+    std::vector<KInARowBoard> boards{ board };
+    history.reset(board.state(), board.hash());
+
+    while (board.winner() < 0 && !board.full()) {
+        int best = -1;
+        int64_t bestThreat = -1;
+        for (int cell = 0; cell < board.cellCount(); cell++) {
+            if (board.at(cell) < 0 && (board.isCandidate(cell) || !board.moveCount())) {
+                int64_t threat = board.threat(cell, board.sideToMove());
+                if (threat > bestThreat) {
+                    best = cell;
+                    bestThreat = threat;
+                }
+            }
+        }
+        board.play(best);
+        history.push(board.state(), board.hash());
+        boards.push_back(board);
+    }
+
+    uint64_t mismatches = 0;
+    auto check = [&](const std::string &state) {
+        int ply = history.current();
+        if (!boardMatches(state, boards[ply]) || history.hashAt(ply) != boards[ply].hash()) {
+            mismatches++;
+        }
+    };
+    while (history.canUndo()) {
+        check(history.undo());
+    }
+    while (history.canRedo()) {
+        check(history.redo());
+    }
+    for (int i = 0; i < history.size(); i++) {
+        check(history.seek((i * 37) % history.size()));
+    }
+
+    // the first player's line along the top row is done before their stone
+    // further down and the second player's last one go down
+    if (width >= k + 1 && height >= 4) {
+        KInARowBoard won(width, height, k);
+        for (int i = 0; i < k; i++) {
+            won.play(i);
+            won.play((i == k - 1 ? 3 : 2) * width + i);
+        }
+        won.play(3 * width + k);
+        if (won.winner() != 0 || !boardMatches(won.state(), won)) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+uint64_t perftOthello(const OthelloBoard &board, int depth)
+{
+    uint64_t moves = board.legalMoves();
+    if (depth == 0) {
+        return 1;
+    }
+    if (!moves) {
+        if (board.gameOver()) {
+            return 1;
+        }
+        OthelloBoard passed = board;
+        passed.pass();
+        return perftOthello(passed, depth - 1);
+    }
+    if (depth == 1) {
+        return popCount(moves);
+    }
+
+    uint64_t nodes = 0;
+    while (moves) {
+        OthelloBoard child = board;
+        child.play(popLSB(moves));
+        nodes += perftOthello(child, depth - 1);
+    }
+    return nodes;
+}
+
+uint64_t perftCheckers(const CheckersBoard &board, int depth)
+{
+    if (depth == 0) {
+        return 1;
+    }
+    CheckersMove moves[CheckersBoard::maxMoves];
+    int count = board.generateMoves(moves);
+    if (depth == 1) {
+        return count;
+    }
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < count; i++) {
+        CheckersBoard child = board;
+        child.play(moves[i]);
+        nodes += perftCheckers(child, depth - 1);
+    }
+    return nodes;
+}
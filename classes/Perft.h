@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Position.h"
+#include "OthelloBoard.h"
+#include "CheckersBoard.h"
+#include "KInARowBoard.h"
+#include <ostream>
+
+//
+// perft walks the legal move tree to a fixed depth and counts the leaves.
+// comparing against published counts is the standard move generator check,
+// and nodes per second is our move generation throughput number.
+// with bulk counting the last ply adds the size of the move list instead of
+// making each move
+//
+
+uint64_t perft(Position &position, int depth, bool bulk = true);
+
+// perft split by root move, printed one "e2e4: 20" line per move
+uint64_t perftDivide(Position &position, int depth, bool bulk, std::ostream &out);
+
+// walks the same tree checking the incrementally updated zobrist key against
+// one computed from scratch at every node, and that unmake restores it.
+// returns the number of mismatches
+uint64_t perftVerifyHash(Position &position, int depth);
+
+// walks the tree round-tripping every node through fen() / setFEN() and
+// pack() / unpack(). returns the number of nodes that didn't come back the same
+uint64_t perftVerifyCodec(Position &position, int depth);
+
+// walks the tree checking at every node that generateCaptures() and generateQuiets()
+// split generateLegalMoves() between them, and that isLegal() accepts exactly those
+// moves out of every from / to / flags combination for the side to move's pieces.
+// returns the number of nodes where they disagree
+uint64_t perftVerifyStages(Position &position, int depth);
+
+// plays plies moves picked off a fixed seed, recording each position packed in a
+// TurnHistory the way the game does, then steps back to the start, forward to the
+// end and seeks across the game checking every position against its fen and hash.
+// returns the number of plies that didn't come back the same
+uint64_t verifyTurnHistory(Position &position, int plies);
+
+// the same for the m,n,k board: plays a game out greedily by threat until
+// someone wins or the board fills, then steps through it reloading every
+// position with setState(), and loads a won position whose line completes
+// before its last stones. returns the number of positions that didn't come back
+uint64_t verifyKInARowHistory(int width, int height, int k);
+
+// othello perft, a forced pass counts as a ply and the tree ends when neither side can move
+uint64_t perftOthello(const OthelloBoard &board, int depth);
+
+// checkers perft, a capture chain is one move
+uint64_t perftCheckers(const CheckersBoard &board, int depth);
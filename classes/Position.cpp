@@ -0,0 +1,909 @@
+#include "Position.h"
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+const char *pieceChars = "PNBRQKpnbrqk";
+
+// castling rights that survive a move touching each square
+struct CastlingMasks {
+    uint8_t mask[64];
+    CastlingMasks() {
+        for (int i = 0; i < 64; i++) {
+            mask[i] = CASTLE_WK | CASTLE_WQ | CASTLE_BK | CASTLE_BQ;
+        }
+        mask[0]  &= ~CASTLE_WQ;
+        mask[7]  &= ~CASTLE_WK;
+        mask[4]  &= ~(CASTLE_WK | CASTLE_WQ);
+        mask[56] &= ~CASTLE_BQ;
+        mask[63] &= ~CASTLE_BK;
+        mask[60] &= ~(CASTLE_BK | CASTLE_BQ);
+    }
+};
+const CastlingMasks castlingMasks;
+
+constexpr uint64_t notAFile = 0xFEFEFEFEFEFEFEFEULL;
+constexpr uint64_t notHFile = 0x7F7F7F7F7F7F7F7FULL;
+constexpr uint64_t rank1    = 0x00000000000000FFULL;
+constexpr uint64_t rank3    = 0x0000000000FF0000ULL;
+constexpr uint64_t rank6    = 0x0000FF0000000000ULL;
+constexpr uint64_t rank8    = 0xFF00000000000000ULL;
+
+// north for positive offsets, south for negative
+template <int Offset>
+constexpr uint64_t shift(uint64_t bitboard)
+{
+    if constexpr (Offset > 0) {
+        return bitboard << Offset;
+    } else {
+        return bitboard >> -Offset;
+    }
+}
+
+// what the generators need to know about the side to move, fixed at compile time
+template <int Us>
+struct Side {
+    static constexpr int them = Us ^ 1;
+    static constexpr int up = Us == WHITE ? 8 : -8;
+    static constexpr int upLeft = Us == WHITE ? 7 : -9;
+    static constexpr int upRight = Us == WHITE ? 9 : -7;
+    // where a pawn that may still push twice stands after its first step
+    static constexpr uint64_t doublePushRank = Us == WHITE ? rank3 : rank6;
+    static constexpr uint64_t promotionRank = Us == WHITE ? rank8 : rank1;
+    static constexpr int kingHome = Us == WHITE ? 4 : 60;
+    static constexpr int kingSide = Us == WHITE ? CASTLE_WK : CASTLE_BK;
+    static constexpr int queenSide = Us == WHITE ? CASTLE_WQ : CASTLE_BQ;
+};
+
+}
+
+Position::Position()
+{
+    initMagicBitboards();
+    clear();
+}
+
+void Position::clear()
+{
+    for (int i = 0; i < e_numBitboards; i++) {
+        _bitboards[i] = 0;
+    }
+    _bitboards[EMPTY_SQUARES] = ~0ULL;
+    for (int i = 0; i < 64; i++) {
+        _board[i] = NO_PIECE;
+    }
+    _sideToMove = WHITE;
+    _castling = 0;
+    _epSquare = NO_SQUARE;
+    _halfmoveClock = 0;
+    _fullmoveNumber = 1;
+    _hash = 0;
+}
+
+bool Position::setFEN(const std::string &fen)
+{
+    clear();
+
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    stream >> placement >> side >> castling >> enPassant;
+
+    //* PIECE PLACEMENT *//
+    int file = 0;
+    int rank = 7;
+    for (char c : placement) {
+        if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else if (c == '/') {
+            rank--;
+            file = 0;
+        } else {
+            const char *found = strchr(pieceChars, c);
+            if (!found || file > 7 || rank < 0) {
+                clear();
+                return false;
+            }
+            putPiece(rank * 8 + file, (int)(found - pieceChars));
+            file++;
+        }
+    }
+
+    //* ACTIVE COLOR *//
+    _sideToMove = (side == "b") ? BLACK : WHITE;
+
+    //* CASTLING RIGHTS *//
+    int rights = 0;
+    for (char c : castling) {
+        if (c == 'K') rights |= CASTLE_WK;
+        else if (c == 'Q') rights |= CASTLE_WQ;
+        else if (c == 'k') rights |= CASTLE_BK;
+        else if (c == 'q') rights |= CASTLE_BQ;
+    }
+
+    //* EN PASSANT TARGET *//
+    int epSquare = NO_SQUARE;
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8') {
+        epSquare = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+    }
+
+    //* CLOCKS *//
+    if (!(stream >> _halfmoveClock)) {
+        _halfmoveClock = 0;
+    }
+    if (!(stream >> _fullmoveNumber)) {
+        _fullmoveNumber = 1;
+    }
+    return finishSetup(rights, epSquare);
+}
+
+// one king each, and the side that just moved can't have left its king in check,
+// otherwise the generators would happily capture a king. castling rights whose king
+// or rook is off its home square are dropped, and the en passant square is only
+// kept when a pawn can actually take, so equal positions hash equally
+bool Position::finishSetup(int castling, int epSquare)
+{
+    if (popCount(pieces(WHITE, King)) != 1 || popCount(pieces(BLACK, King)) != 1
+        || isSquareAttacked(kingSquare(_sideToMove ^ 1), _sideToMove)) {
+        clear();
+        return false;
+    }
+
+    const struct { int right, color, king, rook; } homes[] = {
+        { CASTLE_WK, WHITE, 4, 7 }, { CASTLE_WQ, WHITE, 4, 0 }, { CASTLE_BK, BLACK, 60, 63 }, { CASTLE_BQ, BLACK, 60, 56 }
+    };
+    _castling = 0;
+    for (const auto &home : homes) {
+        if ((castling & home.right) && _board[home.king] == pieceCode(home.color, King)
+            && _board[home.rook] == pieceCode(home.color, Rook)) {
+            _castling |= home.right;
+        }
+    }
+
+    // the square a pawn of the side that just moved skipped over, with that pawn in front of it
+    _epSquare = NO_SQUARE;
+    if (epSquare >= 0 && epSquare < 64) {
+        int them = _sideToMove ^ 1;
+        int pushed = them == WHITE ? epSquare + 8 : epSquare - 8;
+        int start = them == WHITE ? epSquare - 8 : epSquare + 8;
+        bool onRank = epSquare / 8 == (them == WHITE ? 2 : 5);
+        if (onRank && _board[pushed] == pieceCode(them, Pawn) && _board[epSquare] == NO_PIECE && _board[start] == NO_PIECE
+            && (PawnAttacks[them][epSquare] & pieces(_sideToMove, Pawn))) {
+            _epSquare = epSquare;
+        }
+    }
+
+    _hash = computeHash();
+    return true;
+}
+
+std::string Position::fen() const
+{
+    std::string fen;
+    fen.reserve(90);
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            int piece = _board[rank * 8 + file];
+            if (piece == NO_PIECE) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                fen += (char)('0' + empty);
+                empty = 0;
+            }
+            fen += pieceChars[piece];
+        }
+        if (empty) {
+            fen += (char)('0' + empty);
+        }
+        if (rank) {
+            fen += '/';
+        }
+    }
+
+    fen += _sideToMove == WHITE ? " w " : " b ";
+
+    if (_castling == 0) {
+        fen += '-';
+    } else {
+        if (_castling & CASTLE_WK) fen += 'K';
+        if (_castling & CASTLE_WQ) fen += 'Q';
+        if (_castling & CASTLE_BK) fen += 'k';
+        if (_castling & CASTLE_BQ) fen += 'q';
+    }
+
+    fen += ' ';
+    if (_epSquare == NO_SQUARE) {
+        fen += '-';
+    } else {
+        fen += (char)('a' + _epSquare % 8);
+        fen += (char)('1' + _epSquare / 8);
+    }
+
+    fen += ' ' + std::to_string(_halfmoveClock) + ' ' + std::to_string(_fullmoveNumber);
+    return fen;
+}
+
+bool PackedPosition::operator==(const PackedPosition &other) const
+{
+    return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+bool Position::pack(PackedPosition &packed) const
+{
+    memset(packed.bytes, 0, sizeof(packed.bytes));
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    if (popCount(occupancy) > 32) {
+        return false;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        packed.bytes[i] = (uint8_t)(occupancy >> (i * 8));
+    }
+    int nibble = 0;
+    while (occupancy) {
+        int piece = _board[popLSB(occupancy)];
+        packed.bytes[8 + nibble / 2] |= piece << ((nibble & 1) * 4);
+        nibble++;
+    }
+    packed.bytes[24] = (uint8_t)(_sideToMove | _castling << 1);
+    packed.bytes[25] = (uint8_t)_epSquare;
+    packed.bytes[26] = (uint8_t)std::min(_halfmoveClock, 255);
+    packed.bytes[27] = (uint8_t)_fullmoveNumber;
+    packed.bytes[28] = (uint8_t)(_fullmoveNumber >> 8);
+    return true;
+}
+
+bool Position::unpack(const PackedPosition &packed)
+{
+    clear();
+
+    uint64_t occupancy = 0;
+    for (int i = 0; i < 8; i++) {
+        occupancy |= (uint64_t)packed.bytes[i] << (i * 8);
+    }
+    if (popCount(occupancy) > 32) {
+        return false;
+    }
+
+    int nibble = 0;
+    while (occupancy) {
+        int square = popLSB(occupancy);
+        int piece = (packed.bytes[8 + nibble / 2] >> ((nibble & 1) * 4)) & 0xf;
+        if (piece > B_KING) {
+            clear();
+            return false;
+        }
+        putPiece(square, piece);
+        nibble++;
+    }
+    _sideToMove = packed.bytes[24] & 1;
+    _halfmoveClock = packed.bytes[26];
+    _fullmoveNumber = packed.bytes[27] | packed.bytes[28] << 8;
+    return finishSetup((packed.bytes[24] >> 1) & 0xf, packed.bytes[25] < 64 ? packed.bytes[25] : NO_SQUARE);
+}
+
+uint64_t Position::computeHash() const
+{
+    uint64_t hash = 0;
+    for (int square = 0; square < 64; square++) {
+        if (_board[square] != NO_PIECE) {
+            hash ^= Zobrist::keys.pieceSquare[_board[square]][square];
+        }
+    }
+    hash ^= Zobrist::keys.castling[_castling];
+    if (_epSquare != NO_SQUARE) {
+        hash ^= Zobrist::keys.enPassantFile[_epSquare % 8];
+    }
+    if (_sideToMove == BLACK) {
+        hash ^= Zobrist::keys.sideToMove;
+    }
+    return hash;
+}
+
+char Position::pieceNotation(int square) const
+{
+    int piece = _board[square];
+    return piece == NO_PIECE ? '0' : pieceChars[piece];
+}
+
+void Position::putPiece(int square, int piece)
+{
+    uint64_t bit = 1ULL << square;
+    _bitboards[piece] |= bit;
+    _bitboards[W_ALL + pieceColor(piece)] |= bit;
+    _bitboards[OCCUPANCY] |= bit;
+    _bitboards[EMPTY_SQUARES] &= ~bit;
+    _board[square] = piece;
+}
+
+void Position::removePiece(int square)
+{
+    int piece = _board[square];
+    uint64_t bit = 1ULL << square;
+    _bitboards[piece] &= ~bit;
+    _bitboards[W_ALL + pieceColor(piece)] &= ~bit;
+    _bitboards[OCCUPANCY] &= ~bit;
+    _bitboards[EMPTY_SQUARES] |= bit;
+    _board[square] = NO_PIECE;
+}
+
+void Position::movePiece(int from, int to)
+{
+    int piece = _board[from];
+    uint64_t fromTo = (1ULL << from) | (1ULL << to);
+    _bitboards[piece] ^= fromTo;
+    _bitboards[W_ALL + pieceColor(piece)] ^= fromTo;
+    _bitboards[OCCUPANCY] ^= fromTo;
+    _bitboards[EMPTY_SQUARES] ^= fromTo;
+    _board[to] = piece;
+    _board[from] = NO_PIECE;
+}
+
+uint64_t Position::attackersTo(int square, uint64_t occupancy) const
+{
+    uint64_t bishops = _bitboards[W_BISHOPS] | _bitboards[B_BISHOPS] | _bitboards[W_QUEENS] | _bitboards[B_QUEENS];
+    uint64_t rooks = _bitboards[W_ROOKS] | _bitboards[B_ROOKS] | _bitboards[W_QUEENS] | _bitboards[B_QUEENS];
+
+    return (PawnAttacks[BLACK][square] & _bitboards[W_PAWNS])
+         | (PawnAttacks[WHITE][square] & _bitboards[B_PAWNS])
+         | (KnightAttacks[square] & (_bitboards[W_KNIGHTS] | _bitboards[B_KNIGHTS]))
+         | (KingAttacks[square] & (_bitboards[W_KING] | _bitboards[B_KING]))
+         | (getBishopAttacks(square, occupancy) & bishops)
+         | (getRookAttacks(square, occupancy) & rooks);
+}
+
+bool Position::isSquareAttacked(int square, int byColor) const
+{
+    return byColor == WHITE ? isSquareAttacked<WHITE>(square) : isSquareAttacked<BLACK>(square);
+}
+
+template <int Them>
+bool Position::isSquareAttacked(int square) const
+{
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    uint64_t queens = pieces(Them, Queen);
+
+    return (PawnAttacks[Them ^ 1][square] & pieces(Them, Pawn))
+        || (KnightAttacks[square] & pieces(Them, Knight))
+        || (KingAttacks[square] & pieces(Them, King))
+        || (getBishopAttacks(square, occupancy) & (pieces(Them, Bishop) | queens))
+        || (getRookAttacks(square, occupancy) & (pieces(Them, Rook) | queens));
+}
+
+uint64_t Position::pinnedPieces(int color) const
+{
+    return color == WHITE ? pinnedPieces<WHITE>() : pinnedPieces<BLACK>();
+}
+
+template <int Us>
+uint64_t Position::pinnedPieces() const
+{
+    constexpr int them = Side<Us>::them;
+    int king = kingSquare(Us);
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    uint64_t queens = pieces(them, Queen);
+
+    // enemy sliders that would hit the king on an empty board
+    uint64_t snipers = (getRookAttacks(king, 0) & (pieces(them, Rook) | queens))
+                     | (getBishopAttacks(king, 0) & (pieces(them, Bishop) | queens));
+
+    uint64_t pinned = 0;
+    while (snipers) {
+        uint64_t between = BetweenSquares[king][popLSB(snipers)] & occupancy;
+        if (between && !(between & (between - 1))) {
+            pinned |= between & colorPieces(Us);
+        }
+    }
+    return pinned;
+}
+
+void Position::makeMove(const BitMove &move, UndoState &undo)
+{
+    if (_sideToMove == WHITE) {
+        makeMove<WHITE>(move, undo);
+    } else {
+        makeMove<BLACK>(move, undo);
+    }
+}
+
+template <int Us>
+void Position::makeMove(const BitMove &move, UndoState &undo)
+{
+    const auto &keys = Zobrist::keys;
+    int from = move.from();
+    int to = move.to();
+    int piece = _board[from];
+
+    undo.hash = _hash;
+    undo.castling = _castling;
+    undo.epSquare = _epSquare;
+    undo.halfmoveClock = _halfmoveClock;
+    undo.captured = NO_PIECE;
+
+    uint64_t hash = _hash ^ keys.sideToMove;
+    if (_epSquare != NO_SQUARE) {
+        hash ^= keys.enPassantFile[_epSquare % 8];
+    }
+
+    _halfmoveClock++;
+
+    if (move.flags() == MoveEnPassant) {
+        int capturedSquare = to - Side<Us>::up;
+        undo.captured = _board[capturedSquare];
+        hash ^= keys.pieceSquare[undo.captured][capturedSquare];
+        removePiece(capturedSquare);
+    } else if (move.isCapture()) {
+        undo.captured = _board[to];
+        hash ^= keys.pieceSquare[undo.captured][to];
+        removePiece(to);
+    }
+
+    movePiece(from, to);
+    hash ^= keys.pieceSquare[piece][from] ^ keys.pieceSquare[piece][to];
+
+    if (move.isPromotion()) {
+        int promoted = pieceCode(Us, move.promotionPiece());
+        removePiece(to);
+        putPiece(to, promoted);
+        hash ^= keys.pieceSquare[piece][to] ^ keys.pieceSquare[promoted][to];
+    } else if (move.flags() == MoveCastle) {
+        // king side lands on the g file, queen side on the c file
+        int rookFrom = (to > from) ? to + 1 : to - 2;
+        int rookTo = (to > from) ? to - 1 : to + 1;
+        int rook = _board[rookFrom];
+        movePiece(rookFrom, rookTo);
+        hash ^= keys.pieceSquare[rook][rookFrom] ^ keys.pieceSquare[rook][rookTo];
+    }
+
+    _epSquare = NO_SQUARE;
+    if (pieceType(piece) == Pawn) {
+        _halfmoveClock = 0;
+        // only record the square when an enemy pawn can use it
+        int skipped = (from + to) / 2;
+        if (move.flags() == MoveDoublePush && (PawnAttacks[Us][skipped] & pieces(Side<Us>::them, Pawn))) {
+            _epSquare = skipped;
+            hash ^= keys.enPassantFile[skipped % 8];
+        }
+    }
+    if (undo.captured != NO_PIECE) {
+        _halfmoveClock = 0;
+    }
+
+    int castling = _castling & castlingMasks.mask[from] & castlingMasks.mask[to];
+    if (castling != _castling) {
+        hash ^= keys.castling[_castling] ^ keys.castling[castling];
+        _castling = castling;
+    }
+
+    if constexpr (Us == BLACK) {
+        _fullmoveNumber++;
+    }
+    _sideToMove = Side<Us>::them;
+    _hash = hash;
+}
+
+void Position::unmakeMove(const BitMove &move, const UndoState &undo)
+{
+    // the side that made the move
+    if (_sideToMove == BLACK) {
+        unmakeMove<WHITE>(move, undo);
+    } else {
+        unmakeMove<BLACK>(move, undo);
+    }
+}
+
+template <int Us>
+void Position::unmakeMove(const BitMove &move, const UndoState &undo)
+{
+    _sideToMove = Us;
+    int from = move.from();
+    int to = move.to();
+
+    if constexpr (Us == BLACK) {
+        _fullmoveNumber--;
+    }
+
+    if (move.isPromotion()) {
+        removePiece(to);
+        putPiece(to, pieceCode(Us, Pawn));
+    } else if (move.flags() == MoveCastle) {
+        if (to > from) {
+            movePiece(to - 1, to + 1);
+        } else {
+            movePiece(to + 1, to - 2);
+        }
+    }
+
+    movePiece(to, from);
+
+    if (undo.captured != NO_PIECE) {
+        int capturedSquare = to;
+        if (move.flags() == MoveEnPassant) {
+            capturedSquare = to - Side<Us>::up;
+        }
+        putPiece(capturedSquare, undo.captured);
+    }
+
+    _castling = undo.castling;
+    _epSquare = undo.epSquare;
+    _halfmoveClock = undo.halfmoveClock;
+    _hash = undo.hash;
+}
+
+void Position::makeNullMove(UndoState &undo)
+{
+    undo.hash = _hash;
+    undo.castling = _castling;
+    undo.epSquare = _epSquare;
+    undo.halfmoveClock = _halfmoveClock;
+    undo.captured = NO_PIECE;
+
+    _hash ^= Zobrist::keys.sideToMove;
+    if (_epSquare != NO_SQUARE) {
+        _hash ^= Zobrist::keys.enPassantFile[_epSquare % 8];
+        _epSquare = NO_SQUARE;
+    }
+    _halfmoveClock++;
+    _sideToMove ^= 1;
+}
+
+void Position::unmakeNullMove(const UndoState &undo)
+{
+    _sideToMove ^= 1;
+    _epSquare = undo.epSquare;
+    _halfmoveClock = undo.halfmoveClock;
+    _hash = undo.hash;
+}
+
+std::string moveToUCI(const BitMove &move)
+{
+    std::string s;
+    s += (char)('a' + move.from() % 8);
+    s += (char)('1' + move.from() / 8);
+    s += (char)('a' + move.to() % 8);
+    s += (char)('1' + move.to() / 8);
+    if (move.isPromotion()) {
+        s += " nbrq"[move.promotionPiece() - 1];
+    }
+    return s;
+}
+
+// MOVE GENERATIONS //
+void Position::generateLegalMoves(MoveList &moves) const
+{
+    if (_sideToMove == WHITE) {
+        generateLegalMoves<WHITE, GenerateAll>(moves);
+    } else {
+        generateLegalMoves<BLACK, GenerateAll>(moves);
+    }
+}
+
+void Position::generateCaptures(MoveList &moves) const
+{
+    if (_sideToMove == WHITE) {
+        generateLegalMoves<WHITE, GenerateCaptures>(moves);
+    } else {
+        generateLegalMoves<BLACK, GenerateCaptures>(moves);
+    }
+}
+
+void Position::generateQuiets(MoveList &moves) const
+{
+    if (_sideToMove == WHITE) {
+        generateLegalMoves<WHITE, GenerateQuiets>(moves);
+    } else {
+        generateLegalMoves<BLACK, GenerateQuiets>(moves);
+    }
+}
+
+template <int Us, int Type>
+void Position::generateLegalMoves(MoveList &moves) const
+{
+    int king = kingSquare(Us);
+    uint64_t friendlies = colorPieces(Us);
+    uint64_t enemies = colorPieces(Side<Us>::them);
+    uint64_t checkers = attackersTo(king, _bitboards[OCCUPANCY]) & enemies;
+
+    // the squares a piece may land on for this kind of move
+    uint64_t kindMask = Type == GenerateCaptures ? enemies
+                      : Type == GenerateQuiets ? _bitboards[EMPTY_SQUARES]
+                      : ~friendlies;
+    generateKingMoves<Us>(moves, kindMask);
+
+    // in double check only the king can move
+    if (checkers & (checkers - 1)) {
+        return;
+    }
+
+    // in single check every other move has to capture the checker or block its ray
+    uint64_t checkMask = ~0ULL;
+    if (checkers) {
+        checkMask = BetweenSquares[king][bitScanForward(checkers)] | checkers;
+    }
+    uint64_t pinned = pinnedPieces<Us>();
+    uint64_t targets = kindMask & checkMask;
+
+    generatePawnMoves<Us, Type>(moves, checkMask, pinned);
+    if constexpr (Type != GenerateQuiets) {
+        generateEnPassantMoves<Us>(moves, checkers);
+    }
+    generatePieceMoves<Us, Knight>(moves, targets, pinned);
+    generatePieceMoves<Us, Bishop>(moves, targets, pinned);
+    generatePieceMoves<Us, Rook>(moves, targets, pinned);
+    generatePieceMoves<Us, Queen>(moves, targets, pinned);
+    if constexpr (Type != GenerateCaptures) {
+        if (!checkers) {
+            generateCastlingMoves<Us>(moves);
+        }
+    }
+}
+
+bool Position::isLegal(const BitMove &move) const
+{
+    return _sideToMove == WHITE ? isLegal<WHITE>(move) : isLegal<BLACK>(move);
+}
+
+template <int Us>
+bool Position::isLegal(const BitMove &move) const
+{
+    using S = Side<Us>;
+    int from = move.from();
+    int to = move.to();
+    int flags = move.flags();
+    int piece = _board[from];
+    uint64_t toBit = 1ULL << to;
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    uint64_t enemies = colorPieces(S::them);
+    int king = kingSquare(Us);
+    uint64_t checkers = attackersTo(king, occupancy) & enemies;
+
+    if (piece == NO_PIECE || pieceColor(piece) != Us || (colorPieces(Us) & toBit)) {
+        return false;
+    }
+
+    // the two rare kinds are checked by generating them
+    if (flags == MoveCastle || flags == MoveEnPassant) {
+        MoveList special;
+        if (flags == MoveEnPassant) {
+            generateEnPassantMoves<Us>(special, checkers);
+        } else if (!checkers) {
+            generateCastlingMoves<Us>(special);
+        }
+        return std::find(special.begin(), special.end(), move) != special.end();
+    }
+
+    // everything else has to be flagged the way the generator would flag it
+    if (!move.isPromotion() && (flags & MoveCastle)) {
+        return false;
+    }
+    if (move.isCapture() != ((enemies & toBit) != 0)) {
+        return false;
+    }
+
+    ChessPiece type = pieceType(piece);
+    if (type == Pawn) {
+        if (move.isPromotion() != ((toBit & S::promotionRank) != 0)) {
+            return false;
+        }
+        if (move.isCapture()) {
+            if (!(PawnAttacks[Us][from] & toBit)) {
+                return false;
+            }
+        } else if (flags == MoveDoublePush) {
+            uint64_t passed = shift<S::up>(1ULL << from);
+            if (to != from + 2 * S::up || !(passed & S::doublePushRank) || (occupancy & (passed | toBit))) {
+                return false;
+            }
+        } else if (to != from + S::up || (occupancy & toBit)) {
+            return false;
+        }
+    } else {
+        if (move.isPromotion() || flags == MoveDoublePush) {
+            return false;
+        }
+        uint64_t attacks = type == Knight ? KnightAttacks[from]
+                         : type == Bishop ? getBishopAttacks(from, occupancy)
+                         : type == Rook ? getRookAttacks(from, occupancy)
+                         : type == Queen ? getQueenAttacks(from, occupancy)
+                         : KingAttacks[from];
+        if (!(attacks & toBit)) {
+            return false;
+        }
+    }
+
+    // the same masks the generators apply
+    if (type == King) {
+        return !(attackersTo(to, occupancy ^ (1ULL << from)) & enemies);
+    }
+    if (checkers) {
+        if (checkers & (checkers - 1)) {
+            return false;
+        }
+        if (!((BetweenSquares[king][bitScanForward(checkers)] | checkers) & toBit)) {
+            return false;
+        }
+    }
+    if (pinnedPieces<Us>() & (1ULL << from)) {
+        return (LineSquares[king][from] & toBit) != 0;
+    }
+    return true;
+}
+
+template <int Us, ChessPiece Piece>
+void Position::generatePieceMoves(MoveList &moves, uint64_t targets, uint64_t pinned) const
+{
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    uint64_t enemies = colorPieces(Side<Us>::them);
+    int king = kingSquare(Us);
+    uint64_t movers = pieces(Us, Piece);
+    // a pinned knight can never stay on the pin line
+    if constexpr (Piece == Knight) {
+        movers &= ~pinned;
+    }
+    while (movers) {
+        int from = popLSB(movers);
+        uint64_t attacks;
+        if constexpr (Piece == Knight) {
+            attacks = KnightAttacks[from];
+        } else if constexpr (Piece == Bishop) {
+            attacks = getBishopAttacks(from, occupancy);
+        } else if constexpr (Piece == Rook) {
+            attacks = getRookAttacks(from, occupancy);
+        } else {
+            attacks = getQueenAttacks(from, occupancy);
+        }
+        attacks &= targets;
+        if (pinned & (1ULL << from)) {
+            attacks &= LineSquares[king][from];
+        }
+        uint64_t captures = attacks & enemies;
+        attacks ^= captures;
+        while (captures) {
+            moves.emplace_back(from, popLSB(captures), MoveCapture);
+        }
+        while (attacks) {
+            moves.emplace_back(from, popLSB(attacks));
+        }
+    }
+}
+
+template <int Us>
+void Position::generateKingMoves(MoveList &moves, uint64_t targets) const
+{
+    int king = kingSquare(Us);
+    uint64_t enemies = colorPieces(Side<Us>::them);
+    targets &= KingAttacks[king];
+
+    // test with the king lifted off the board so it can't hide behind itself on a checking ray
+    uint64_t withoutKing = _bitboards[OCCUPANCY] ^ (1ULL << king);
+    while (targets) {
+        int to = popLSB(targets);
+        if (!(attackersTo(to, withoutKing) & enemies)) {
+            moves.emplace_back(king, to, (enemies & (1ULL << to)) ? MoveCapture : MoveNormal);
+        }
+    }
+}
+
+template <int Us, int Type>
+void Position::generatePawnMoves(MoveList &moves, uint64_t checkMask, uint64_t pinned) const
+{
+    using S = Side<Us>;
+    uint64_t pawns = pieces(Us, Pawn);
+    if (pawns == 0) {
+        return;
+    }
+
+    int king = kingSquare(Us);
+    uint64_t empty = _bitboards[EMPTY_SQUARES];
+    uint64_t singleMoves = shift<S::up>(pawns) & empty;
+
+    if constexpr (Type != GenerateQuiets) {
+        uint64_t enemies = colorPieces(S::them);
+        uint64_t capturesLeft = shift<S::upLeft>(pawns & notAFile) & enemies;
+        uint64_t capturesRight = shift<S::upRight>(pawns & notHFile) & enemies;
+        addPawnMoves<S::upLeft, MoveCapture>(moves, capturesLeft & checkMask, S::promotionRank, pinned, king);
+        addPawnMoves<S::upRight, MoveCapture>(moves, capturesRight & checkMask, S::promotionRank, pinned, king);
+    }
+    if constexpr (Type == GenerateCaptures) {
+        // pushes that promote count with the captures
+        addPawnMoves<S::up, MoveNormal>(moves, singleMoves & S::promotionRank & checkMask, S::promotionRank, pinned, king);
+    } else {
+        uint64_t doubleMoves = shift<S::up>(singleMoves & S::doublePushRank) & empty;
+        if constexpr (Type == GenerateQuiets) {
+            singleMoves &= ~S::promotionRank;
+        }
+        addPawnMoves<S::up, MoveNormal>(moves, singleMoves & checkMask, S::promotionRank, pinned, king);
+        addPawnMoves<2 * S::up, MoveDoublePush>(moves, doubleMoves & checkMask, 0, pinned, king);
+    }
+}
+
+// every pawn in targets came from Offset squares behind it, Flags is MoveCapture for captures
+template <int Offset, int Flags>
+void Position::addPawnMoves(MoveList &moves, uint64_t targets, uint64_t promotionRank, uint64_t pinned, int king) const
+{
+    // a pinned pawn may only move along the line through its king
+    auto leavesPin = [&](int from, int to) {
+        return (pinned & (1ULL << from)) && !(LineSquares[king][from] & (1ULL << to));
+    };
+
+    uint64_t promotions = targets & promotionRank;
+    targets ^= promotions;
+    while (promotions) {
+        int to = popLSB(promotions);
+        int from = to - Offset;
+        if (leavesPin(from, to)) {
+            continue;
+        }
+        moves.emplace_back(from, to, Flags | MovePromoteQueen);
+        moves.emplace_back(from, to, Flags | MovePromoteRook);
+        moves.emplace_back(from, to, Flags | MovePromoteBishop);
+        moves.emplace_back(from, to, Flags | MovePromoteKnight);
+    }
+    while (targets) {
+        int to = popLSB(targets);
+        int from = to - Offset;
+        if (leavesPin(from, to)) {
+            continue;
+        }
+        moves.emplace_back(from, to, Flags);
+    }
+}
+
+// en passant removes two pieces from one rank, which pin masks can't describe,
+// so each candidate is checked against the sliders with the resulting occupancy
+template <int Us>
+void Position::generateEnPassantMoves(MoveList &moves, uint64_t checkers) const
+{
+    if (_epSquare == NO_SQUARE) {
+        return;
+    }
+
+    constexpr int them = Side<Us>::them;
+    int king = kingSquare(Us);
+    int capturedSquare = _epSquare - Side<Us>::up;
+    uint64_t captured = 1ULL << capturedSquare;
+
+    // a knight or pawn check can only be answered by capturing the pawn that gives it
+    if (checkers & ~captured & ~(pieces(them, Bishop) | pieces(them, Rook) | pieces(them, Queen))) {
+        return;
+    }
+
+    uint64_t queens = pieces(them, Queen);
+    uint64_t attackers = PawnAttacks[them][_epSquare] & pieces(Us, Pawn);
+    while (attackers) {
+        int from = popLSB(attackers);
+        uint64_t occupancy = (_bitboards[OCCUPANCY] ^ (1ULL << from) ^ captured) | (1ULL << _epSquare);
+        if ((getBishopAttacks(king, occupancy) & (pieces(them, Bishop) | queens))
+            || (getRookAttacks(king, occupancy) & (pieces(them, Rook) | queens))) {
+            continue;
+        }
+        moves.emplace_back(from, _epSquare, MoveEnPassant);
+    }
+}
+
+template <int Us>
+void Position::generateCastlingMoves(MoveList &moves) const
+{
+    using S = Side<Us>;
+    if (!(_castling & (S::kingSide | S::queenSide))) {
+        return;
+    }
+
+    // only called when not in check
+    constexpr int king = S::kingHome;
+    uint64_t occupancy = _bitboards[OCCUPANCY];
+    // the squares between king and rook must be empty, the ones the king crosses unattacked
+    if ((_castling & S::kingSide) && !(occupancy & (3ULL << (king + 1)))
+        && !isSquareAttacked<S::them>(king + 1) && !isSquareAttacked<S::them>(king + 2)) {
+        moves.emplace_back(king, king + 2, MoveCastle);
+    }
+    if ((_castling & S::queenSide) && !(occupancy & (7ULL << (king - 3)))
+        && !isSquareAttacked<S::them>(king - 1) && !isSquareAttacked<S::them>(king - 2)) {
+        moves.emplace_back(king, king - 2, MoveCastle);
+    }
+}
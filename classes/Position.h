@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "MagicBitboards.h"
+#include "MoveList.h"
+#include "Zobrist.h"
+#include <string>
+#include <vector>
+
+//
+// headless chess position
+// twelve piece bitboards plus the aggregate boards, a mailbox for piece lookups,
+// side to move, castling rights, en passant square and the move clocks.
+// it has no knowledge of Grid, Bit or Sprite so the engine can copy it,
+// make and unmake moves on it and generate moves without touching the heap
+//
+
+constexpr int NO_PIECE = -1;
+constexpr int NO_SQUARE = -1;
+
+enum CastlingRights {
+    CASTLE_WK = 1,
+    CASTLE_WQ = 2,
+    CASTLE_BK = 4,
+    CASTLE_BQ = 8
+};
+
+// fixed-size binary form of a position, for turn history, hashing and datasets.
+// occupancy (8 bytes), one nibble per piece in square order (16 bytes),
+// side and castling (1), en passant square (1), halfmove clock (1), fullmove number (2)
+struct PackedPosition {
+    uint8_t bytes[32];
+
+    bool operator==(const PackedPosition &other) const;
+    bool operator!=(const PackedPosition &other) const { return !(*this == other); }
+};
+
+// everything makeMove() destroys that unmakeMove() needs back
+struct UndoState {
+    uint64_t    hash;
+    int8_t      captured;
+    uint8_t     castling;
+    int8_t      epSquare;
+    int         halfmoveClock;
+};
+
+class Position
+{
+public:
+    Position();
+
+    void clear();
+    // parses all six FEN fields, missing trailing fields get their defaults
+    bool setFEN(const std::string &fen);
+    std::string fen() const;
+
+    // false when the position can't be packed (more than 32 pieces) or the bytes aren't a position
+    bool pack(PackedPosition &packed) const;
+    bool unpack(const PackedPosition &packed);
+
+    uint64_t pieces(int bitboard) const { return _bitboards[bitboard]; }
+    uint64_t pieces(int color, ChessPiece piece) const { return _bitboards[color * 6 + piece - 1]; }
+    uint64_t colorPieces(int color) const { return _bitboards[W_ALL + color]; }
+    uint64_t occupancy() const { return _bitboards[OCCUPANCY]; }
+    int pieceAt(int square) const { return _board[square]; }
+    char pieceNotation(int square) const;
+
+    int sideToMove() const { return _sideToMove; }
+    int castlingRights() const { return _castling; }
+    int enPassantSquare() const { return _epSquare; }
+    int halfmoveClock() const { return _halfmoveClock; }
+    int fullmoveNumber() const { return _fullmoveNumber; }
+    // zobrist key, updated incrementally by makeMove() and restored by unmakeMove()
+    uint64_t hash() const { return _hash; }
+    // the same key built from scratch, for setup and for checking the incremental one
+    uint64_t computeHash() const;
+    int kingSquare(int color) const { return bitScanForward(_bitboards[color == WHITE ? W_KING : B_KING]); }
+
+    // pieces of both colors attacking square, with the given occupancy for slider rays
+    uint64_t attackersTo(int square, uint64_t occupancy) const;
+    bool isSquareAttacked(int square, int byColor) const;
+    bool inCheck() const { return isSquareAttacked(kingSquare(_sideToMove), _sideToMove ^ 1); }
+    // pieces of color that are the only thing between their king and an enemy slider
+    uint64_t pinnedPieces(int color) const;
+
+    void makeMove(const BitMove &move, UndoState &undo);
+    void unmakeMove(const BitMove &move, const UndoState &undo);
+    // pass the turn, for null move pruning. never legal in check
+    void makeNullMove(UndoState &undo);
+    void unmakeNullMove(const UndoState &undo);
+
+    // legal moves only: checkers and pins are computed once up front and every
+    // generator is masked with them, so no move is made and tested
+    void generateLegalMoves(MoveList &moves) const;
+    // the same moves in two halves, so a search can stop before generating the quiet ones.
+    // captures includes every promotion, quiets is everything else
+    void generateCaptures(MoveList &moves) const;
+    void generateQuiets(MoveList &moves) const;
+    // whether generateLegalMoves() would produce move here, without generating. for
+    // trying moves remembered from other positions, any 16 bit value is safe to test
+    bool isLegal(const BitMove &move) const;
+
+    static int pieceColor(int piece) { return piece >= B_PAWNS ? BLACK : WHITE; }
+    static ChessPiece pieceType(int piece) { return (ChessPiece)(piece % 6 + 1); }
+    static int pieceCode(int color, ChessPiece piece) { return color * 6 + piece - 1; }
+
+private:
+    enum GenerationType { GenerateAll, GenerateCaptures, GenerateQuiets };
+
+    // validates the placed pieces and sets castling, en passant and the hash, for setFEN() and unpack()
+    bool finishSetup(int castling, int epSquare);
+
+    void putPiece(int square, int piece);
+    void removePiece(int square);
+    void movePiece(int from, int to);
+
+    // the public entry points check the side to move once and call these,
+    // specialized for it so pawn directions and ranks are constants
+    template <int Them> bool isSquareAttacked(int square) const;
+    template <int Us> uint64_t pinnedPieces() const;
+    template <int Us> void makeMove(const BitMove &move, UndoState &undo);
+    template <int Us> void unmakeMove(const BitMove &move, const UndoState &undo);
+    template <int Us, int Type> void generateLegalMoves(MoveList &moves) const;
+    template <int Us> bool isLegal(const BitMove &move) const;
+    template <int Us, int Type> void generatePawnMoves(MoveList &moves, uint64_t checkMask, uint64_t pinned) const;
+    template <int Offset, int Flags> void addPawnMoves(MoveList &moves, uint64_t targets, uint64_t promotionRank, uint64_t pinned, int king) const;
+    template <int Us> void generateEnPassantMoves(MoveList &moves, uint64_t checkers) const;
+    template <int Us, ChessPiece Piece> void generatePieceMoves(MoveList &moves, uint64_t targets, uint64_t pinned) const;
+    template <int Us> void generateKingMoves(MoveList &moves, uint64_t targets) const;
+    template <int Us> void generateCastlingMoves(MoveList &moves) const;
+
+    uint64_t    _bitboards[e_numBitboards];
+    int8_t      _board[64];
+    int         _sideToMove;
+    int         _castling;
+    int         _epSquare;
+    int         _halfmoveClock;
+    int         _fullmoveNumber;
+    uint64_t    _hash;
+};
+
+// long algebraic notation as used by UCI, e.g. e2e4 or e7e8q
+std::string moveToUCI(const BitMove &move);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+
+//
+// pieces the game searches share
+// a search scores a won game as its win score less the plies to the win, so
+// anything past winInMaxPly is a forced result. the transposition table keeps
+// those as the distance from the node they were found at rather than from
+// the root, so they stay right wherever the node comes up again. the
+// deadline holds a search's start time and move time
+//
+
+namespace SearchScores {
+
+// the board games' bounds: beyond every score, and a won game at ply 0
+constexpr int INFINITE_SCORE = 32000;
+constexpr int WIN_SCORE = 30000;
+
+}
+
+inline int scoreToTT(int score, int ply, int winInMaxPly)
+{
+    if (score >= winInMaxPly) return score + ply;
+    if (score <= -winInMaxPly) return score - ply;
+    return score;
+}
+
+inline int scoreFromTT(int score, int ply, int winInMaxPly)
+{
+    if (score >= winInMaxPly) return score - ply;
+    if (score <= -winInMaxPly) return score + ply;
+    return score;
+}
+
+class SearchDeadline
+{
+public:
+    // starts the clock, a move time of 0 never runs out
+    void start(int moveTimeMs)
+    {
+        _start = std::chrono::steady_clock::now();
+        _moveTimeMs = moveTimeMs;
+    }
+
+    int elapsedMs() const
+    {
+        return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+    bool expired() const { return _moveTimeMs && elapsedMs() >= _moveTimeMs; }
+    // past half the budget the next iteration would most likely not finish
+    bool roomForIteration() const { return !_moveTimeMs || elapsedMs() * 2 <= _moveTimeMs; }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+    int _moveTimeMs = 0;
+};
+
+// full-window iterative deepening. iteration(depth) searches one depth and
+// returns its score, stopped() says the search was cut off during it, and
+// completed(score, depth) records each depth that finished. stops early once
+// a forced result is found or the next depth won't fit the deadline
+template <typename Iteration, typename Stopped, typename Completed>
+void iterativeDeepening(int maxDepth, int winInMaxPly, const SearchDeadline &deadline,
+                        Iteration iteration, Stopped stopped, Completed completed)
+{
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        int score = iteration(depth);
+        if (stopped()) {
+            break;
+        }
+        completed(score, depth);
+        if (std::abs(score) >= winInMaxPly || !deadline.roomForIteration()) {
+            break;
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "Entity.h"
 #include "../imgui/imgui.h"
+#include "TextureCache.h"
+#include <cstdint>
 
 class Sprite : public Entity
 {
@@ -16,11 +18,15 @@ public:
         _scale(1),
         _color(1, 1, 1, 1),
         _localZOrder(0),
+        _texture(nullptr),
         _highlighted(false)
         { 
             _entityType = EntitySprite;
         };
-    ~Sprite() { if (_retainCount > 0) release(); }
+    ~Sprite() { TextureCache::release(_texture); if (_retainCount > 0) release(); }
+    // a copy would release the texture twice
+    Sprite(const Sprite &) = delete;
+    Sprite &operator=(const Sprite &) = delete;
     
     // set the texture to use for this sprite
     void setPosition(float x, float y)
@@ -59,14 +65,18 @@ public:
     float getRotation() { return _rotation; }
     // moveTo
     void moveTo(const ImVec2 &point) { _location = point; }
-    // draw the sprite
-    void paintSprite()
+    const ImVec2 &getSize() const { return _size; }
+    // draw the sprite as a quad in drawList, origin is the window-local zero
+    void paintSprite(ImDrawList *drawList, const ImVec2 &origin)
     {
-        if (_size.x > 0.0f && _size.y > 0.0f) 
+        if (_texture && _size.x > 0.0f && _size.y > 0.0f) 
         {
-            ImGui::SetCursorPos(_location);
-            ImVec4 highlight = _highlighted ? ImVec4(1, 1, 0, 1) : ImVec4(0, 0, 0, 0);
-            ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
+            ImVec2 min(origin.x + _location.x, origin.y + _location.y);
+            ImVec2 max(min.x + _size.x, min.y + _size.y);
+            drawList->AddImage(_texture->id, min, max, _texture->uv0, _texture->uv1, ImGui::ColorConvertFloat4ToU32(_color));
+            if (_highlighted) {
+                drawList->AddRect(min, max, IM_COL32(255, 255, 0, 255));
+            }
         }
     }
 	// is the mouse over this position?
@@ -75,7 +85,16 @@ public:
         return (mousePos.x >= _location.x && mousePos.x <= _location.x + _size.x && mousePos.y >= _location.y && mousePos.y <= _location.y + _size.y);
     }
 
+    // takes the image from the texture cache, loading it only the first time
     bool LoadTextureFromFile(const char* filename);
+    // share a texture another sprite already loaded
+    const Texture *getTexture() const { return _texture; }
+    void setTexture(const Texture *texture)
+    {
+        TextureCache::retain(texture);
+        TextureCache::release(_texture);
+        _texture = texture;
+    }
 	
     // set the highlighted state
 	virtual void	setHighlighted(bool yes);
@@ -100,10 +119,8 @@ protected:
     ImVec4  _color;
     // the local Z order
     int _localZOrder;
-    // the texture we're going to draw
-    ImTextureID _texture;
+    // the texture we're going to draw, shared through the texture cache
+    const Texture *_texture;
     // currently highlighted
    	bool	_highlighted;
-    // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
 };
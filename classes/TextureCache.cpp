@@ -0,0 +1,294 @@
+#include "TextureCache.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include <algorithm>
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// everything the games draw, packed together on first use
+constexpr const char *kAtlasFiles[] = {
+    "boardsquare.png", "square.png",
+    "x.png", "o.png", "red.png", "yellow.png",
+    "w_pawn.png", "w_knight.png", "w_bishop.png", "w_rook.png", "w_queen.png", "w_king.png",
+    "b_pawn.png", "b_knight.png", "b_bishop.png", "b_rook.png", "b_queen.png", "b_king.png",
+};
+constexpr int kAtlasWidth = 512;
+// each image's edge pixels are repeated once around it so filtering never
+// samples its neighbour
+constexpr int kAtlasPadding = 1;
+
+struct Entry : Texture {
+    std::string name;
+    int         refs = 0;
+    bool        inAtlas = false;
+};
+
+std::unordered_map<std::string, Entry> entries;
+ImTextureID atlasId = 0;
+// users of any image in the atlas
+int atlasRefs = 0;
+int textureCount = 0;
+
+ImTextureID uploadTexture(const unsigned char *imageData, int imageWidth, int imageHeight);
+void freeTexture(ImTextureID id);
+
+struct Image {
+    unsigned char *pixels = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+Image loadImage(const char *filename)
+{
+    Image image;
+    std::filesystem::path resourcePath = std::filesystem::path("resources") / filename;
+    std::string path = resourcePath.string();
+    image.pixels = stbi_load(path.c_str(), &image.width, &image.height, NULL, 4);
+    if (!image.pixels) {
+        std::cout << "Failed to load texture: " << path << std::endl;
+    }
+    return image;
+}
+
+bool isAtlasFile(const std::string &name)
+{
+    for (const char *file : kAtlasFiles) {
+        if (name == file) return true;
+    }
+    return false;
+}
+
+// shelf packs every atlas file into one texture and adds their entries
+void buildAtlas()
+{
+    struct Placed {
+        const char *name;
+        Image image;
+        int x, y;
+    };
+    std::vector<Placed> placed;
+    int x = 0, y = 0, shelfHeight = 0;
+    for (const char *file : kAtlasFiles) {
+        Image image = loadImage(file);
+        if (!image.pixels) continue;
+        int cellWidth = image.width + 2 * kAtlasPadding;
+        int cellHeight = image.height + 2 * kAtlasPadding;
+        if (x + cellWidth > kAtlasWidth) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        placed.push_back({ file, image, x + kAtlasPadding, y + kAtlasPadding });
+        x += cellWidth;
+        shelfHeight = std::max(shelfHeight, cellHeight);
+    }
+    if (placed.empty()) return;
+
+    int atlasHeight = 1;
+    while (atlasHeight < y + shelfHeight) atlasHeight <<= 1;
+    std::vector<unsigned char> pixels((size_t)kAtlasWidth * atlasHeight * 4, 0);
+    for (const Placed &p : placed) {
+        for (int row = -kAtlasPadding; row < p.image.height + kAtlasPadding; row++) {
+            int srcRow = std::clamp(row, 0, p.image.height - 1);
+            for (int col = -kAtlasPadding; col < p.image.width + kAtlasPadding; col++) {
+                int srcCol = std::clamp(col, 0, p.image.width - 1);
+                const unsigned char *src = p.image.pixels + ((size_t)srcRow * p.image.width + srcCol) * 4;
+                unsigned char *dst = pixels.data() + ((size_t)(p.y + row) * kAtlasWidth + p.x + col) * 4;
+                std::copy(src, src + 4, dst);
+            }
+        }
+    }
+
+    atlasId = uploadTexture(pixels.data(), kAtlasWidth, atlasHeight);
+    if (atlasId) {
+        textureCount++;
+    }
+    for (Placed &p : placed) {
+        if (atlasId) {
+            Entry &entry = entries[p.name];
+            entry.name = p.name;
+            entry.inAtlas = true;
+            entry.id = atlasId;
+            entry.uv0 = ImVec2((float)p.x / kAtlasWidth, (float)p.y / atlasHeight);
+            entry.uv1 = ImVec2((float)(p.x + p.image.width) / kAtlasWidth, (float)(p.y + p.image.height) / atlasHeight);
+            entry.size = ImVec2((float)p.image.width, (float)p.image.height);
+        }
+        stbi_image_free(p.image.pixels);
+    }
+}
+
+}
+
+namespace TextureCache {
+
+const Texture *acquire(const char *filename)
+{
+    std::string name = filename;
+    auto found = entries.find(name);
+    if (found == entries.end() && isAtlasFile(name) && !atlasId) {
+        buildAtlas();
+        found = entries.find(name);
+    }
+    if (found == entries.end()) {
+        Image image = loadImage(filename);
+        if (!image.pixels) return nullptr;
+        ImTextureID id = uploadTexture(image.pixels, image.width, image.height);
+        stbi_image_free(image.pixels);
+        if (!id) return nullptr;
+        textureCount++;
+
+        Entry &entry = entries[name];
+        entry.name = name;
+        entry.id = id;
+        entry.size = ImVec2((float)image.width, (float)image.height);
+        found = entries.find(name);
+    }
+    retain(&found->second);
+    return &found->second;
+}
+
+void retain(const Texture *texture)
+{
+    if (!texture) return;
+    Entry *entry = const_cast<Entry *>(static_cast<const Entry *>(texture));
+    entry->refs++;
+    if (entry->inAtlas) {
+        atlasRefs++;
+    }
+}
+
+void release(const Texture *texture)
+{
+    if (!texture) return;
+    Entry *entry = const_cast<Entry *>(static_cast<const Entry *>(texture));
+    entry->refs--;
+    if (!entry->inAtlas) {
+        if (entry->refs <= 0) {
+            freeTexture(entry->id);
+            textureCount--;
+            std::string name = entry->name;
+            entries.erase(name);
+        }
+        return;
+    }
+
+    // the atlas goes when nothing drawn from it is left
+    if (--atlasRefs <= 0) {
+        freeTexture(atlasId);
+        textureCount--;
+        atlasId = 0;
+        atlasRefs = 0;
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.inAtlas ? entries.erase(it) : std::next(it);
+        }
+    }
+}
+
+int liveTextures()
+{
+    return textureCount;
+}
+
+}
+
+#ifdef __APPLE__
+#include "../imgui/imgui_impl_opengl3_loader.h"
+
+namespace {
+
+ImTextureID uploadTexture(const unsigned char *imageData, int imageWidth, int imageHeight)
+{
+    // Create a OpenGL texture identifier
+    GLuint imageTexture;
+    glGenTextures(1, &imageTexture);
+    glBindTexture(GL_TEXTURE_2D, imageTexture);
+
+    // Setup filtering parameters for display
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Upload pixels into texture
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+
+    return static_cast<ImTextureID>(imageTexture);
+}
+
+void freeTexture(ImTextureID id)
+{
+    GLuint imageTexture = (GLuint)id;
+    glDeleteTextures(1, &imageTexture);
+}
+
+}
+
+#else
+
+// DirectX
+#include <stdio.h>
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "d3dcompiler") // Automatically link with d3dcompiler.lib as we are using D3DCompile() below.
+#endif
+
+namespace {
+
+ImTextureID uploadTexture(const unsigned char *imageData, int imageWidth, int imageHeight)
+{
+    // Create texture
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = imageWidth;
+    desc.Height = imageHeight;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+
+    ID3D11Texture2D *pTexture = NULL;
+    D3D11_SUBRESOURCE_DATA subResource;
+    subResource.pSysMem = imageData;
+    subResource.SysMemPitch = desc.Width * 4;
+    subResource.SysMemSlicePitch = 0;
+
+    // You need to have a valid ID3D11Device* available as g_pd3dDevice
+    extern ID3D11Device* g_pd3dDevice; // Add this line if g_pd3dDevice is defined elsewhere
+
+    HRESULT hr = g_pd3dDevice->CreateTexture2D(&desc, &subResource, &pTexture);
+    if (FAILED(hr) || !pTexture) {
+        return 0;
+    }
+
+    // Create texture view
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = desc.MipLevels;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+
+    ID3D11ShaderResourceView* shaderResourceView = nullptr;
+    hr = g_pd3dDevice->CreateShaderResourceView(pTexture, &srvDesc, &shaderResourceView);
+    pTexture->Release();
+
+    if (FAILED(hr) || !shaderResourceView) {
+        return 0;
+    }
+    return reinterpret_cast<ImTextureID>(shaderResourceView);
+}
+
+void freeTexture(ImTextureID id)
+{
+    reinterpret_cast<ID3D11ShaderResourceView*>(id)->Release();
+}
+
+}
+#endif
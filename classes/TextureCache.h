@@ -0,0 +1,32 @@
+#pragma once
+#include "../imgui/imgui.h"
+
+//
+// shared textures for sprites, keyed by file name under resources/
+// the board and piece art is packed into one atlas texture, uploaded the
+// first time any of it is asked for; other files get a texture each. every
+// acquire is paired with a release and the GPU texture is freed when its last
+// user lets go, so placing and flipping pieces never touches the disk or
+// allocates video memory once the art is loaded
+//
+
+struct Texture {
+    ImTextureID id = 0;     // the atlas or a texture of its own
+    ImVec2      uv0 = ImVec2(0, 0);
+    ImVec2      uv1 = ImVec2(1, 1);
+    ImVec2      size = ImVec2(0, 0);    // of the image in pixels
+};
+
+namespace TextureCache {
+
+// the texture for filename, nullptr if it can't be loaded
+const Texture *acquire(const char *filename);
+// gives back a texture from acquire or retain, nullptr is ignored
+void release(const Texture *texture);
+// another user for a texture already acquired
+void retain(const Texture *texture);
+
+// GPU textures currently alive, the atlas counts once
+int liveTextures();
+
+}
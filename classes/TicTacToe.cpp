@@ -4,6 +4,8 @@
 TicTacToe::TicTacToe()
 {
     _grid = new Grid(3, 3);
+    _marks[0] = _marks[1] = 0;
+    _hash = 0;
 }
 
 TicTacToe::~TicTacToe()
@@ -30,6 +32,8 @@ void TicTacToe::setUpBoard()
     _gameOptions.rowX = 3;
     _gameOptions.rowY = 3;
     _grid->initializeSquares(80, "square.png");
+    _marks[0] = _marks[1] = 0;
+    _hash = 0;
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
@@ -46,8 +50,13 @@ bool TicTacToe::actionForEmptyHolder(BitHolder &holder)
     if (holder.bit()) {
         return false;
     }
-    Bit *bit = PieceForPlayer(getCurrentPlayer()->playerNumber() == 0 ? HUMAN_PLAYER : AI_PLAYER);
+    int playerNumber = getCurrentPlayer()->playerNumber();
+    Bit *bit = PieceForPlayer(playerNumber == 0 ? HUMAN_PLAYER : AI_PLAYER);
     if (bit) {
+        ChessSquare *square = static_cast<ChessSquare*>(&holder);
+        int index = square->getRow() * 3 + square->getColumn();
+        _marks[playerNumber] |= 1 << index;
+        _hash ^= Zobrist::boardKey(playerNumber, index);
         bit->setPosition(holder.getPosition());
         holder.setBit(bit);
         endTurn();
@@ -76,44 +85,24 @@ void TicTacToe::stopGame()
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-}
-
-//
-// helper function for the winner check
-//
-Player* TicTacToe::ownerAt(int index ) const
-{
-    auto square = _grid->getSquare(index % 3, index / 3);
-    if (!square || !square->bit()) {
-        return nullptr;
-    }
-    return square->bit()->getOwner();
+    _marks[0] = _marks[1] = 0;
+    _hash = 0;
 }
 
 Player* TicTacToe::checkForWinner()
 {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        Player *player = ownerAt(triple[0]);
-        if( player && player == ownerAt(triple[1]) && player == ownerAt(triple[2]) )
-            return player;
+    for (int playerNumber = 0; playerNumber < 2; playerNumber++) {
+        if (TicTacToeTable::hasWon(_marks[playerNumber])) {
+            return getPlayerAt(playerNumber);
+        }
     }
     return nullptr;
 }
 
 bool TicTacToe::checkForDraw()
 {
-    bool isDraw = true;
-    // check to see if the board is full
-    _grid->forEachSquare([&isDraw](ChessSquare* square, int x, int y) {
-        if (!square->bit()) {
-            isDraw = false;
-        }
-    });
-    return isDraw;
+    // the board is full
+    return (_marks[0] | _marks[1]) == TicTacToeTable::kFullBoard;
 }
 
 //
@@ -131,12 +120,13 @@ std::string TicTacToe::initialStateString()
 std::string TicTacToe::stateString()
 {
     std::string s = "000000000";
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit *bit = square->bit();
-        if (bit) {
-            s[y * 3 + x] = std::to_string(bit->getOwner()->playerNumber()+1)[0];
+    for (int index = 0; index < 9; index++) {
+        for (int playerNumber = 0; playerNumber < 2; playerNumber++) {
+            if ((_marks[playerNumber] >> index) & 1) {
+                s[index] = '1' + playerNumber;
+            }
         }
-    });
+    }
     return s;
 }
 
@@ -146,102 +136,43 @@ std::string TicTacToe::stateString()
 //
 void TicTacToe::setStateString(const std::string &s)
 {
+    _marks[0] = _marks[1] = 0;
+    _hash = 0;
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
         int index = y*3 + x;
         int playerNumber = s[index] - '0';
         if (playerNumber) {
             square->setBit( PieceForPlayer(playerNumber-1) );
+            _marks[playerNumber - 1] |= 1 << index;
+            _hash ^= Zobrist::boardKey(playerNumber - 1, index);
         } else {
             square->setBit( nullptr );
         }
     });
 }
 
-
-//
-// this is the function that will be called by the AI
-//
-void TicTacToe::updateAI() 
+uint64_t TicTacToe::zobristKey()
 {
-    int bestVal = -1000;
-    BitHolder* bestMove = nullptr;
-    std::string state = stateString();
-
-    // Traverse all cells, evaluate minimax function for all empty cells
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 3 + x;
-        // Check if cell is empty
-        if (state[index] == '0') {
-            // Make the move
-            state[index] = '2';
-            int moveVal = -negamax(state, 0, HUMAN_PLAYER);
-            // Undo the move
-            state[index] = '0';
-            // If the value of the current move is more than the best value, update best
-            if (moveVal > bestVal) {
-                bestMove = square;
-                bestVal = moveVal;
-            }
-        }
-    });
-
-
-    // Make the best move
-    if(bestMove) {
-        if (actionForEmptyHolder(*bestMove)) {
-        }
-    }
+    return getCurrentPlayer()->playerNumber() ? _hash ^ Zobrist::keys.sideToMove : _hash;
 }
 
-bool isAIBoardFull(const std::string& state) {
-    return state.find('0') == std::string::npos;
-}
-
-int evaluateAIBoard(const std::string& state) {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        char first = state[triple[0]];
-        if( first != '0' && first == state[triple[1]] && first == state[triple[2]] ) {
-            return 10;   // someone won, negamax will handle who
-        }
-    }
-    return 0; // No winner
-}
 
 //
-// player is the current player's number (AI or human)
+// this is the function that will be called by the AI
+// the whole game was solved at compile time, so this is one table lookup
 //
-int TicTacToe::negamax(std::string& state, int depth, int playerColor) 
+void TicTacToe::updateAI() 
 {
-    int score = evaluateAIBoard(state);
-
-    // Check if AI wins, human wins, or draw
-    if(score) { 
-        // A winning state is a loss for the player whose turn it is.
-        // The previous player made the winning move.
-        return -score; 
-    }
-
-    if(isAIBoardFull(state)) {
-        return 0; // Draw
+    int playerNumber = getCurrentPlayer()->playerNumber();
+    uint16_t mine = _marks[playerNumber];
+    uint16_t theirs = _marks[playerNumber ^ 1];
+    int cell = TicTacToeTable::bestMove(mine, theirs);
+    // a loaded state the table can't reach, take any empty cell
+    uint16_t empty = ~(mine | theirs) & TicTacToeTable::kFullBoard;
+    if (cell < 0 && empty && !checkForWinner()) {
+        cell = bitScanForward(empty);
     }
-
-    int bestVal = -1000; // Min value
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            // Check if cell is empty
-            if (state[y * 3 + x] == '0') {
-                // Make the move
-                state[y * 3 + x] = playerColor == HUMAN_PLAYER ? '1' : '2'; // Set the cell to the current player's color
-                bestVal = std::max(bestVal, -negamax(state, depth + 1, -playerColor));
-                // Undo the move for backtracking
-                state[y * 3 + x] = '0';
-            }
-        }
+    if (cell >= 0) {
+        actionForEmptyHolder(*_grid->getSquare(cell % 3, cell / 3));
     }
-
-    return bestVal;
-}
\ No newline at end of file
+}
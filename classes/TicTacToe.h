@@ -1,5 +1,8 @@
 #pragma once
 #include "Game.h"
+#include "Zobrist.h"
+#include "TicTacToeTable.h"
+#include "Bitboard.h"
 
 //
 // the classic game of tic tac toe
@@ -22,6 +25,7 @@ public:
     std::string initialStateString() override;
     std::string stateString() override;
     void        setStateString(const std::string &s) override;
+    uint64_t    zobristKey() override;
     bool        actionForEmptyHolder(BitHolder &holder) override;
     bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
@@ -32,9 +36,11 @@ public:
     Grid* getGrid() override { return _grid; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
-    Player*     ownerAt(int index ) const;
-    int         negamax(std::string& state, int depth, int playerColor);
 
     Grid*       _grid;
+    // each player's marks, bit y * 3 + x; the grid only mirrors them for drawing
+    uint16_t    _marks[2];
+    // zobrist key of the pieces on the board, updated as they are placed
+    uint64_t    _hash;
 };
 
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// tic-tac-toe solved at compile time
+// a position is two 9-bit masks, the side to move's marks and the other
+// side's, bit y * 3 + x for each cell. the table holds the perfect-play move
+// and value of every position reachable from the empty board, looked up by
+// the base 3 number whose digits are 0 empty, 1 the mover's and 2 the
+// other side's. it is built once by the compiler from a memoised negamax,
+// so a move costs one lookup at run time whoever started the game
+//
+
+namespace TicTacToeTable {
+
+constexpr int kCells = 9;
+constexpr int kStates = 19683;  // 3^9
+constexpr uint16_t kFullBoard = 0x1FF;
+
+constexpr uint16_t kWinningLines[8] = {
+    0x007, 0x038, 0x1C0,    // rows
+    0x049, 0x092, 0x124,    // cols
+    0x111, 0x054            // diagonals
+};
+
+constexpr int kPowersOfThree[kCells] = { 1, 3, 9, 27, 81, 243, 729, 2187, 6561 };
+
+constexpr bool hasWon(uint16_t marks)
+{
+    for (uint16_t line : kWinningLines) {
+        if ((marks & line) == line) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr int indexOf(uint16_t mine, uint16_t theirs)
+{
+    int index = 0;
+    for (int cell = 0; cell < kCells; cell++) {
+        index += (((mine >> cell) & 1) + 2 * ((theirs >> cell) & 1)) * kPowersOfThree[cell];
+    }
+    return index;
+}
+
+struct Table {
+    // for the side to move: wins are 1 + the empties left after the winning
+    // move, so quicker wins score higher; losses the negative; draws 0
+    int8_t value[kStates];
+    // cell to play, -1 when the game is over or the position can't be reached
+    int8_t bestMove[kStates];
+};
+
+constexpr int8_t kUnknown = INT8_MIN;
+
+// index is the position from the mover's side, swapped from the other side's;
+// a move turns one into the other so both are carried down
+constexpr int8_t solve(Table &table, uint16_t mine, uint16_t theirs, int index, int swapped)
+{
+    if (table.value[index] != kUnknown) {
+        return table.value[index];
+    }
+
+    int empties = kCells;
+    for (int cell = 0; cell < kCells; cell++) {
+        empties -= ((mine | theirs) >> cell) & 1;
+    }
+
+    int8_t best = 0;
+    int8_t bestMove = -1;
+    if (hasWon(theirs)) {
+        best = (int8_t)-(1 + empties);
+    } else if (empties > 0) {
+        best = -kCells - 1;
+        for (int cell = 0; cell < kCells; cell++) {
+            if (((mine | theirs) >> cell) & 1) {
+                continue;
+            }
+            int8_t value = (int8_t)-solve(table, theirs, (uint16_t)(mine | 1 << cell),
+                swapped + 2 * kPowersOfThree[cell], index + kPowersOfThree[cell]);
+            if (value > best) {
+                best = value;
+                bestMove = (int8_t)cell;
+            }
+        }
+    }
+
+    table.value[index] = best;
+    table.bestMove[index] = bestMove;
+    return best;
+}
+
+constexpr Table build()
+{
+    Table table{};
+    for (int i = 0; i < kStates; i++) {
+        table.value[i] = kUnknown;
+        table.bestMove[i] = -1;
+    }
+    solve(table, 0, 0, 0, 0);
+    return table;
+}
+
+inline constexpr Table table = build();
+
+// perfect-play cell for the side owning mine, -1 if the game is over
+constexpr int bestMove(uint16_t mine, uint16_t theirs) { return table.bestMove[indexOf(mine, theirs)]; }
+
+static_assert(table.value[0] == 0, "perfect play from the empty board is a draw");
+static_assert(bestMove(0x003, 0x030) == 2, "complete a row to win");
+static_assert(bestMove(0x010, 0x003) == 2, "block a row");
+
+}
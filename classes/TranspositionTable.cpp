@@ -0,0 +1,134 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+TranspositionTable::TranspositionTable(size_t megabytes) : _bucketCount(0), _generation(0)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    size_t bytes = std::max<size_t>(megabytes, 1) << 20;
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes) {
+        count *= 2;
+    }
+    if (count != _bucketCount) {
+        _buckets.reset(new Bucket[count]);
+        _bucketCount = count;
+    }
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < _bucketCount; i++) {
+        for (Slot &slot : _buckets[i].slots) {
+            slot.keyXorData.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    _generation = 0;
+}
+
+uint64_t TranspositionTable::pack(uint16_t move, int score, int eval, int depth, Bound bound, uint8_t generation)
+{
+    score = std::clamp(score, -32767, 32767);
+    eval = std::clamp(eval, -32767, 32767);
+    depth = std::clamp(depth, -128, 127);
+    return (uint64_t)move
+        | (uint64_t)(uint16_t)score << 16
+        | (uint64_t)(uint16_t)eval << 32
+        | (uint64_t)(uint8_t)depth << 48
+        | (uint64_t)bound << 56
+        | (uint64_t)generation << 58;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data)
+{
+    Entry entry;
+    entry.move = (uint16_t)data;
+    entry.score = (int16_t)(data >> 16);
+    entry.eval = (int16_t)(data >> 32);
+    entry.depth = (int8_t)(data >> 48);
+    entry.bound = (Bound)((data >> 56) & 3);
+    return entry;
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry &entry) const
+{
+    const Bucket &bucket = bucketFor(key);
+    for (const Slot &slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && data != 0) {
+            entry = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, Bound bound, uint16_t move, int eval)
+{
+    Bucket &bucket = bucketFor(key);
+    Slot *replace = nullptr;
+    int worst = 1 << 30;
+
+    for (Slot &slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.keyXorData.load(std::memory_order_relaxed);
+
+        if (data != 0 && (check ^ data) == key) {
+            // same position: keep a deeper result from this search unless the new one is exact
+            if (bound != BOUND_EXACT && generationOf(data) == _generation && depth < depthOf(data) - 2) {
+                return;
+            }
+            if (move == 0) {
+                move = (uint16_t)data;
+            }
+            replace = &slot;
+            break;
+        }
+
+        // depth preferred, each search of age costs the entry eight plies, empty slots go first
+        int age = (_generation - generationOf(data)) & kGenerationMask;
+        int priority = data == 0 ? -(1 << 29) : depthOf(data) - 8 * age;
+        if (priority < worst) {
+            replace = &slot;
+            worst = priority;
+        }
+    }
+
+    uint64_t data = pack(move, score, eval, depth, bound, _generation);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::prefetch(uint64_t key) const
+{
+#if defined(_MSC_VER)
+    _mm_prefetch((const char *)&bucketFor(key), _MM_HINT_T0);
+#else
+    __builtin_prefetch(&bucketFor(key));
+#endif
+}
+
+int TranspositionTable::hashfull() const
+{
+    size_t buckets = std::min<size_t>(_bucketCount, 250);
+    int used = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        for (const Slot &slot : _buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && generationOf(data) == _generation) {
+                used++;
+            }
+        }
+    }
+    return (int)(used * 1000 / (buckets * kBucketEntries));
+}
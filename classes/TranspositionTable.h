@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//
+// shared transposition table for the game tree searches
+// entries are two 64-bit words, the packed data and the key xor'd with it.
+// a reader only trusts an entry when key ^ data gives back its own key, so a
+// write torn by another thread reads as a miss instead of a wrong result and
+// no locks are needed. four entries make one 64-byte bucket, a single cache
+// line per probe. replacement prefers deep entries from the current search,
+// older searches age out through the generation counter
+//
+// the move field is 16 bits and opaque to the table, each game packs its own
+// move into it (chess from/to/flags, checkers the ends of a chain, othello a square index)
+//
+
+class TranspositionTable
+{
+public:
+    enum Bound : uint8_t {
+        BOUND_NONE = 0,
+        BOUND_UPPER = 1,    // fail low, score is at most this
+        BOUND_LOWER = 2,    // fail high, score is at least this
+        BOUND_EXACT = 3
+    };
+
+    struct Entry {
+        uint16_t    move;
+        int16_t     score;
+        int16_t     eval;
+        int8_t      depth;
+        Bound       bound;
+    };
+
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    // reallocates and clears, rounded down to a power of two number of buckets
+    void resize(size_t megabytes);
+    void clear();
+    size_t sizeMB() const { return (_bucketCount * sizeof(Bucket)) >> 20; }
+
+    // call once at the start of every search so stale entries lose replacement priority
+    void newSearch() { _generation = (_generation + 1) & kGenerationMask; }
+
+    bool probe(uint64_t key, Entry &entry) const;
+    void store(uint64_t key, int score, int depth, Bound bound, uint16_t move, int eval = 0);
+    void prefetch(uint64_t key) const;
+
+    // permille of sampled entries written by the current search, as UCI reports it
+    int hashfull() const;
+
+private:
+    static constexpr int kBucketEntries = 4;
+    static constexpr uint8_t kGenerationMask = 0x3f;
+
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[kBucketEntries];
+    };
+
+    // data layout: move 16 | score 16 | eval 16 | depth 8 | bound 2 | generation 6
+    static uint64_t pack(uint16_t move, int score, int eval, int depth, Bound bound, uint8_t generation);
+    static Entry unpack(uint64_t data);
+    static int depthOf(uint64_t data) { return (int8_t)(data >> 48); }
+    static uint8_t generationOf(uint64_t data) { return (data >> 58) & kGenerationMask; }
+
+    Bucket &bucketFor(uint64_t key) const { return _buckets[key & (_bucketCount - 1)]; }
+
+    std::unique_ptr<Bucket[]>   _buckets;
+    size_t                      _bucketCount;
+    uint8_t                     _generation;
+};
@@ -0,0 +1,125 @@
+#include "TurnHistory.h"
+
+void TurnHistory::reset(const std::string &state, uint64_t hash)
+{
+    _plies.clear();
+    _changes.clear();
+    _keyframes.clear();
+    _current = 0;
+    _state = state;
+
+    Ply start;
+    start.hash = hash;
+    start.score = 0;
+    start.firstChange = 0;
+    start.keyframeOffset = 0;
+    start.keyframeLength = (uint32_t)state.size();
+    start.hasDelta = false;
+    _plies.push_back(start);
+    _keyframes = state;
+}
+
+void TurnHistory::push(const std::string &state, uint64_t hash, int score)
+{
+    if (_plies.empty()) {
+        reset(state, hash);
+        return;
+    }
+
+    // a new turn after an undo replaces everything that was undone
+    if (canRedo()) {
+        _changes.resize(_plies[_current + 1].firstChange);
+        _keyframes.resize(_plies[_current + 1].keyframeOffset);
+        _plies.resize(_current + 1);
+    }
+
+    Ply ply;
+    ply.hash = hash;
+    ply.score = score;
+    ply.firstChange = (uint32_t)_changes.size();
+    ply.keyframeOffset = (uint32_t)_keyframes.size();
+    ply.keyframeLength = 0;
+    ply.hasDelta = state.size() == _state.size() && state.size() <= UINT16_MAX + 1u;
+    if (ply.hasDelta) {
+        for (size_t i = 0; i < state.size(); i++) {
+            if (state[i] != _state[i]) {
+                _changes.push_back({ (uint16_t)i, _state[i], state[i] });
+            }
+        }
+    }
+    if (!ply.hasDelta || size() % keyframeInterval == 0) {
+        ply.keyframeLength = (uint32_t)state.size();
+        _keyframes += state;
+    }
+    _plies.push_back(ply);
+    _state = state;
+    _current++;
+}
+
+const std::string &TurnHistory::undo()
+{
+    if (canUndo()) {
+        if (_plies[_current].hasDelta) {
+            applyBackward(_current, _state);
+        } else {
+            _state = stateAt(_current - 1);
+        }
+        _current--;
+    }
+    return _state;
+}
+
+const std::string &TurnHistory::redo()
+{
+    if (canRedo()) {
+        _current++;
+        applyForward(_current, _state);
+    }
+    return _state;
+}
+
+const std::string &TurnHistory::seek(int ply)
+{
+    if (ply >= 0 && ply < size() && ply != _current) {
+        _state = stateAt(ply);
+        _current = ply;
+    }
+    return _state;
+}
+
+std::string TurnHistory::stateAt(int ply) const
+{
+    int keyframe = ply;
+    while (!_plies[keyframe].keyframeLength && keyframe > 0) {
+        keyframe--;
+    }
+    std::string state = _keyframes.substr(_plies[keyframe].keyframeOffset, _plies[keyframe].keyframeLength);
+    for (int next = keyframe + 1; next <= ply; next++) {
+        applyForward(next, state);
+    }
+    return state;
+}
+
+uint32_t TurnHistory::changesEnd(int ply) const
+{
+    return ply + 1 < size() ? _plies[ply + 1].firstChange : (uint32_t)_changes.size();
+}
+
+void TurnHistory::applyForward(int ply, std::string &state) const
+{
+    const Ply &record = _plies[ply];
+    if (!record.hasDelta) {
+        state = _keyframes.substr(record.keyframeOffset, record.keyframeLength);
+        return;
+    }
+    for (uint32_t i = record.firstChange; i < changesEnd(ply); i++) {
+        state[_changes[i].index] = _changes[i].after;
+    }
+}
+
+void TurnHistory::applyBackward(int ply, std::string &state) const
+{
+    for (uint32_t i = _plies[ply].firstChange; i < changesEnd(ply); i++) {
+        state[_changes[i].index] = _changes[i].before;
+    }
+}
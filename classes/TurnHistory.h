@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// the game's positions, one per ply, as the changes each turn made to the
+// state string. the changes of every ply share one arena and every
+// keyframeInterval plies the whole state is kept too, so any position is
+// rebuilt from the keyframe before it plus at most that many deltas. the
+// current state is kept whole, stepping one ply back or forward only applies
+// that ply's changes. pushing after an undo drops the plies that were undone
+//
+
+class TurnHistory
+{
+public:
+    static constexpr int keyframeInterval = 32;
+
+    // starts over from the position at the start of the game
+    void reset(const std::string &state, uint64_t hash);
+    // records the position after a turn
+    void push(const std::string &state, uint64_t hash, int score = 0);
+
+    // positions recorded, the start of the game included
+    int size() const { return (int)_plies.size(); }
+    // ply of the current position, 0 at the start of the game
+    int current() const { return _current; }
+    const std::string &state() const { return _state; }
+
+    bool canUndo() const { return _current > 0; }
+    bool canRedo() const { return _current + 1 < size(); }
+    // step one ply back or forward, returning the state there
+    const std::string &undo();
+    const std::string &redo();
+    // makes ply the current position
+    const std::string &seek(int ply);
+
+    // any recorded position, rebuilt from its keyframe
+    std::string stateAt(int ply) const;
+    uint64_t hashAt(int ply) const { return _plies[ply].hash; }
+    int scoreAt(int ply) const { return _plies[ply].score; }
+
+private:
+    struct Change {
+        uint16_t    index;
+        char        before;
+        char        after;
+    };
+
+    struct Ply {
+        uint64_t    hash;
+        int         score;
+        // this ply's changes are _changes[firstChange, next ply's firstChange)
+        uint32_t    firstChange;
+        // keyframe text is _keyframes[keyframeOffset, + keyframeLength), length 0 for none
+        uint32_t    keyframeOffset;
+        uint32_t    keyframeLength;
+        // false when the state changed length, the keyframe is all there is
+        bool        hasDelta;
+    };
+
+    uint32_t changesEnd(int ply) const;
+    void applyForward(int ply, std::string &state) const;
+    void applyBackward(int ply, std::string &state) const;
+
+    std::vector<Ply>    _plies;
+    std::vector<Change> _changes;
+    std::string         _keyframes;
+    std::string         _state;
+    int                 _current = 0;
+};
@@ -0,0 +1,370 @@
+#include "UciEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace {
+
+const char *startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+constexpr int defaultHashMB = 64;
+constexpr int maxHashMB = 65536;
+constexpr int maxThreads = 1024;
+// kept back from the clock for the gui and the os
+constexpr int moveOverheadMs = 50;
+
+// positions for the bench command, the same set perft checks
+const char *benchFENs[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+std::string lowercase(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return s;
+}
+
+std::string scoreToUCI(int score)
+{
+    if (score >= MATE_IN_MAX_PLY) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    }
+    if (score <= -MATE_IN_MAX_PLY) {
+        return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+uint64_t nodesPerSecond(uint64_t nodes, int milliseconds)
+{
+    return milliseconds > 0 ? nodes * 1000 / milliseconds : nodes * 1000;
+}
+
+}
+
+UciEngine::UciEngine(std::ostream &out)
+    : _out(out), _tt(defaultHashMB), _search(_tt, 1), _searching(false), _holdBestMove(false), _ponderBudgetMs(0), _timerCancelled(false)
+{
+    _position.setFEN(startFEN);
+    _search.setIterationCallback([this](const SearchResult &result) { printInfo(result); });
+}
+
+UciEngine::~UciEngine()
+{
+    stopSearch();
+}
+
+void UciEngine::run(std::istream &in)
+{
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!command(line)) {
+            break;
+        }
+    }
+    stopSearch();
+}
+
+bool UciEngine::command(const std::string &line)
+{
+    std::istringstream args(line);
+    std::string token;
+    if (!(args >> token)) {
+        return true;
+    }
+
+    if (token == "uci") {
+        uci();
+    } else if (token == "isready") {
+        send("readyok");
+    } else if (token == "ucinewgame") {
+        stopSearch();
+        _tt.clear();
+    } else if (token == "setoption") {
+        setOption(args);
+    } else if (token == "position") {
+        setPosition(args);
+    } else if (token == "go") {
+        go(args);
+    } else if (token == "stop") {
+        stopSearch();
+    } else if (token == "ponderhit") {
+        ponderHit();
+    } else if (token == "bench") {
+        bench(args);
+    } else if (token == "quit") {
+        stopSearch();
+        return false;
+    } else {
+        send("info string unknown command " + token);
+    }
+    return true;
+}
+
+void UciEngine::uci()
+{
+    send("id name GameEngine Chess");
+    send("id author the ClassGame authors");
+    send("option name Hash type spin default " + std::to_string(defaultHashMB) + " min 1 max " + std::to_string(maxHashMB));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(maxThreads));
+    send("option name Ponder type check default false");
+    send("uciok");
+}
+
+// setoption name <id> [value <x>]
+void UciEngine::setOption(std::istringstream &args)
+{
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    args >> value;
+    name = lowercase(name);
+
+    stopSearch();
+    if (name == "hash" && !value.empty()) {
+        _tt.resize(std::clamp(atoi(value.c_str()), 1, maxHashMB));
+    } else if (name == "threads" && !value.empty()) {
+        _search.setThreads(std::clamp(atoi(value.c_str()), 1, maxThreads));
+    }
+}
+
+// position [startpos | fen <fen>] [moves <move> ...]
+void UciEngine::setPosition(std::istringstream &args)
+{
+    stopSearch();
+
+    std::string token, fen;
+    args >> token;
+    if (token == "startpos") {
+        fen = startFEN;
+        args >> token;
+    } else if (token == "fen") {
+        while (args >> token && token != "moves") {
+            fen += token + " ";
+        }
+    } else {
+        return;
+    }
+
+    Position position;
+    if (!position.setFEN(fen)) {
+        send("info string invalid fen " + fen);
+        return;
+    }
+    _position = position;
+    _history.clear();
+
+    MoveList moves;
+    while (args >> token) {
+        moves.clear();
+        _position.generateLegalMoves(moves);
+        auto found = std::find_if(moves.begin(), moves.end(), [&](const BitMove &move) { return moveToUCI(move) == token; });
+        if (found == moves.end()) {
+            send("info string illegal move " + token);
+            break;
+        }
+        _history.push_back(_position.hash());
+        UndoState undo;
+        _position.makeMove(*found, undo);
+    }
+}
+
+// go [ponder] [infinite] [wtime <x>] [btime <x>] [winc <x>] [binc <x>] [movestogo <x>] [depth <x>] [nodes <x>] [movetime <x>]
+void UciEngine::go(std::istringstream &args)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    int time[2] = { 0, 0 };
+    int increment[2] = { 0, 0 };
+    int movesToGo = 0;
+    int moveTime = 0;
+    bool infinite = false;
+    bool ponder = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "wtime") args >> time[WHITE];
+        else if (token == "btime") args >> time[BLACK];
+        else if (token == "winc") args >> increment[WHITE];
+        else if (token == "binc") args >> increment[BLACK];
+        else if (token == "movestogo") args >> movesToGo;
+        else if (token == "depth") args >> limits.maxDepth;
+        else if (token == "nodes") args >> limits.maxNodes;
+        else if (token == "movetime") args >> moveTime;
+        else if (token == "infinite") infinite = true;
+        else if (token == "ponder") ponder = true;
+    }
+
+    // with a clock, spend an even share of what's left plus most of the increment
+    int us = _position.sideToMove();
+    int budget = moveTime;
+    if (!budget && time[us] > 0) {
+        int share = time[us] / (movesToGo > 0 ? movesToGo : 30) + increment[us] * 3 / 4;
+        budget = std::max(1, std::min(share, time[us] - moveOverheadMs));
+    }
+
+    _holdBestMove = infinite || ponder;
+    _ponderBudgetMs = ponder ? budget : 0;
+    limits.moveTimeMs = _holdBestMove ? 0 : budget;
+
+    _search.setHistory(_history);
+    _searching.store(true);
+    _searchThread = std::thread([this, limits, position = _position]() {
+        SearchResult result = _search.search(position, limits);
+
+        {
+            std::unique_lock<std::mutex> lock(_stateLock);
+            _stateChanged.wait(lock, [this] { return !_holdBestMove; });
+        }
+
+        for (size_t i = 0; i < result.threadNodes.size() && result.threadNodes.size() > 1; i++) {
+            send("info string thread " + std::to_string(i) + " nodes " + std::to_string(result.threadNodes[i])
+                + " nps " + std::to_string(nodesPerSecond(result.threadNodes[i], result.elapsedMs)));
+        }
+
+        // no legal moves leaves the move empty
+        std::string bestMove = result.bestMove.isNull() ? "0000" : moveToUCI(result.bestMove);
+        if (result.pv.size() > 1) {
+            send("bestmove " + bestMove + " ponder " + moveToUCI(result.pv[1]));
+        } else {
+            send("bestmove " + bestMove);
+        }
+        _searching.store(false);
+    });
+}
+
+// bench [depth]: fixed depth searches of a set of positions, for comparing nps across builds and thread counts
+void UciEngine::bench(std::istringstream &args)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    limits.maxDepth = 10;
+    args >> limits.maxDepth;
+
+    uint64_t nodes = 0;
+    int milliseconds = 0;
+    std::vector<uint64_t> threadNodes;
+    _search.setIterationCallback(nullptr);
+    _search.setHistory({});
+    for (const char *fen : benchFENs) {
+        Position position;
+        position.setFEN(fen);
+        _tt.clear();
+        SearchResult result = _search.search(position, limits);
+        nodes += result.nodes;
+        milliseconds += result.elapsedMs;
+        threadNodes.resize(result.threadNodes.size());
+        for (size_t i = 0; i < result.threadNodes.size(); i++) {
+            threadNodes[i] += result.threadNodes[i];
+        }
+        send("info string " + std::string(fen) + " bestmove " + moveToUCI(result.bestMove) + " nodes " + std::to_string(result.nodes));
+    }
+    _search.setIterationCallback([this](const SearchResult &result) { printInfo(result); });
+
+    for (size_t i = 0; i < threadNodes.size(); i++) {
+        send("info string thread " + std::to_string(i) + " nps " + std::to_string(nodesPerSecond(threadNodes[i], milliseconds)));
+    }
+    send("Total time (ms) : " + std::to_string(milliseconds));
+    send("Nodes searched  : " + std::to_string(nodes));
+    send("Nodes/second    : " + std::to_string(nodesPerSecond(nodes, milliseconds)));
+}
+
+void UciEngine::stopSearch()
+{
+    {
+        std::lock_guard<std::mutex> lock(_stateLock);
+        _holdBestMove = false;
+    }
+    _stateChanged.notify_all();
+    cancelTimer();
+
+    if (_searchThread.joinable()) {
+        // the thread may not have reached the search yet, which resets the stop flag, so keep asking
+        while (_searching.load()) {
+            _search.stop();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        _searchThread.join();
+    }
+}
+
+void UciEngine::waitForSearch()
+{
+    if (_searchThread.joinable()) {
+        _searchThread.join();
+    }
+}
+
+// the opponent played the move we were pondering on, so the clock is now ours
+void UciEngine::ponderHit()
+{
+    int budget;
+    {
+        std::lock_guard<std::mutex> lock(_stateLock);
+        _holdBestMove = false;
+        budget = _ponderBudgetMs;
+        _ponderBudgetMs = 0;
+    }
+    _stateChanged.notify_all();
+    if (budget > 0) {
+        startTimer(budget);
+    } else {
+        _search.stop();
+    }
+}
+
+void UciEngine::startTimer(int milliseconds)
+{
+    cancelTimer();
+    _timerCancelled = false;
+    _timerThread = std::thread([this, milliseconds]() {
+        std::unique_lock<std::mutex> lock(_stateLock);
+        if (!_stateChanged.wait_for(lock, std::chrono::milliseconds(milliseconds), [this] { return _timerCancelled; })) {
+            _search.stop();
+        }
+    });
+}
+
+void UciEngine::cancelTimer()
+{
+    if (!_timerThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_stateLock);
+        _timerCancelled = true;
+    }
+    _stateChanged.notify_all();
+    _timerThread.join();
+}
+
+void UciEngine::printInfo(const SearchResult &result)
+{
+    std::string line = "info depth " + std::to_string(result.depth)
+        + " score " + scoreToUCI(result.score)
+        + " nodes " + std::to_string(result.nodes)
+        + " nps " + std::to_string(nodesPerSecond(result.nodes, result.elapsedMs))
+        + " time " + std::to_string(result.elapsedMs)
+        + " hashfull " + std::to_string(_tt.hashfull())
+        + " pv";
+    for (const BitMove &move : result.pv) {
+        line += ' ';
+        line += moveToUCI(move);
+    }
+    send(line);
+}
+
+void UciEngine::send(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(_outLock);
+    _out << line << std::endl;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ParallelSearch.h"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//
+// universal chess interface driver
+// reads commands a line at a time and answers on the output stream. searches
+// run on their own thread so stop, ponderhit and isready are handled while the
+// engine thinks; info lines come from that thread, everything written goes
+// through one lock so lines never interleave
+//
+
+class UciEngine
+{
+public:
+    UciEngine(std::ostream &out);
+    ~UciEngine();
+
+    // reads until quit or end of input
+    void run(std::istream &in);
+    // handles one command, returns false on quit
+    bool command(const std::string &line);
+    // blocks until the current search (if any) has printed its bestmove
+    void waitForSearch();
+
+private:
+    void uci();
+    void setOption(std::istringstream &args);
+    void setPosition(std::istringstream &args);
+    void go(std::istringstream &args);
+    void bench(std::istringstream &args);
+    void stopSearch();
+    void ponderHit();
+
+    void startTimer(int milliseconds);
+    void cancelTimer();
+    void printInfo(const SearchResult &result);
+    void send(const std::string &line);
+
+    std::ostream &          _out;
+    std::mutex              _outLock;
+
+    TranspositionTable      _tt;
+    ParallelSearch          _search;
+    Position                _position;
+    // keys of the positions before the current one, for repetition draws
+    std::vector<uint64_t>   _history;
+
+    std::thread             _searchThread;
+    std::atomic<bool>       _searching;
+    // infinite and ponder searches hold their bestmove until stop or ponderhit
+    std::mutex              _stateLock;
+    std::condition_variable _stateChanged;
+    bool                    _holdBestMove;
+    int                     _ponderBudgetMs;
+
+    // stops a ponder search once ponderhit starts its clock
+    std::thread             _timerThread;
+    bool                    _timerCancelled;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// 64-bit zobrist keys, generated at compile time from a fixed splitmix64
+// stream so they are identical in every build and every run.
+// chess uses its own piece/castling/en passant tables, the other board games
+// share a generic [piece][square] table
+//
+
+namespace Zobrist {
+
+constexpr int kMaxBoardPieces = 4;
+constexpr int kMaxBoardSquares = 256;
+
+struct Keys {
+    // chess
+    uint64_t pieceSquare[12][64];
+    uint64_t castling[16];
+    uint64_t enPassantFile[8];
+    uint64_t sideToMove;
+    // othello, checkers, tic-tac-toe
+    uint64_t boardPiece[kMaxBoardPieces][kMaxBoardSquares];
+};
+
+constexpr uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys makeKeys()
+{
+    Keys keys{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (auto &piece : keys.pieceSquare) {
+        for (auto &key : piece) {
+            key = splitmix64(state);
+        }
+    }
+    // castling is keyed by the whole rights mask, no rights hashes to zero
+    for (int i = 1; i < 16; i++) {
+        keys.castling[i] = splitmix64(state);
+    }
+    for (auto &key : keys.enPassantFile) {
+        key = splitmix64(state);
+    }
+    keys.sideToMove = splitmix64(state);
+    for (auto &piece : keys.boardPiece) {
+        for (auto &key : piece) {
+            key = splitmix64(state);
+        }
+    }
+    return keys;
+}
+
+inline constexpr Keys keys = makeKeys();
+
+// generic board games: piece is 0 based, square is y * width + x
+inline uint64_t boardKey(int piece, int square) { return keys.boardPiece[piece][square]; }
+
+}
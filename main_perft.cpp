@@ -0,0 +1,304 @@
+// perft: headless move generator correctness and throughput check
+//
+// usage: perft [--suite <name>|all] [--depth <n>] [--fen "<fen>"] [--epd <file>] [--divide] [--no-bulk]
+//              [--verify-hash] [--verify-codec] [--verify-stages] [--verify-history]
+//              [--othello] [--checkers] [--kinarow-history]
+//
+// with no arguments every suite runs at its default depth. node counts are
+// checked against the published values and the process exits non-zero on a
+// mismatch, which is what the ctest entries rely on. --epd runs a perft suite
+// file instead, one position per line with ";D<depth> <count>" operations.
+// --verify-hash checks the incremental zobrist key at every node instead of
+// counting, --verify-codec round-trips every node through FEN and the packed form.
+// --verify-stages checks the split capture / quiet generators and isLegal() at every node.
+// --verify-history plays --depth times ten plies through the turn history and checks
+// that undo, redo and seek bring every position back whole.
+// --othello and --checkers count those games' trees from the start position instead.
+// --kinarow-history does the --verify-history round trip for m,n,k boards, won games included.
+// chess counts also report the heap allocations made during them and fail if
+// there are any: move lists live on the stack
+
+#include "classes/Perft.h"
+#include "classes/Epd.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+// every heap allocation the process makes, the array forms come through here too
+static std::atomic<uint64_t> gAllocations{ 0 };
+
+void *operator new(std::size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+struct PerftSuite {
+    const char *name;
+    const char *fen;
+    int         defaultDepth;
+    uint64_t    expected[7];    // expected[depth], 0 where unknown
+};
+
+// positions and counts from https://www.chessprogramming.org/Perft_Results
+static const PerftSuite kSuites[] = {
+    { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+        { 1, 20, 400, 8902, 197281, 4865609, 119060324 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5,
+        { 1, 48, 2039, 97862, 4085603, 193690690, 8031647685ULL } },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6,
+        { 1, 14, 191, 2812, 43238, 674624, 11030083 } },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+        { 1, 6, 264, 9467, 422333, 15833292, 706045033 } },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5,
+        { 1, 44, 1486, 62379, 2103487, 89941194, 0 } },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+        { 1, 46, 2079, 89890, 3894594, 164075551, 6923051137ULL } },
+};
+
+// othello from the start position, the published counts with passes counted as a ply
+static const uint64_t kOthelloExpected[] = { 1, 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284 };
+constexpr int kOthelloDefaultDepth = 9;
+
+// checkers from the start position, the published counts with a capture chain as one move
+static const uint64_t kCheckersExpected[] = { 1, 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564, 85242128 };
+constexpr int kCheckersDefaultDepth = 9;
+
+static void usage()
+{
+    std::cerr << "usage: perft [--suite <name>|all] [--depth <n>] [--fen \"<fen>\"] [--epd <file>] [--divide] [--no-bulk]\n";
+    std::cerr << "             [--verify-hash] [--verify-codec] [--verify-stages] [--verify-history]\n";
+    std::cerr << "             [--othello] [--checkers] [--kinarow-history]\n";
+    std::cerr << "suites:";
+    for (const PerftSuite &suite : kSuites) {
+        std::cerr << " " << suite.name;
+    }
+    std::cerr << "\n";
+}
+
+// returns true when the count matches (or there is nothing to compare against)
+static bool runPerft(const char *name, const std::string &fen, int depth, uint64_t expected, bool bulk, bool divide)
+{
+    Position position;
+    if (!position.setFEN(fen)) {
+        std::cerr << name << ": bad fen \"" << fen << "\"\n";
+        return false;
+    }
+
+    uint64_t allocationsBefore = gAllocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = divide ? perftDivide(position, depth, bulk, std::cout) : perft(position, depth, bulk);
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocations = gAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double nps = seconds > 0.0 ? nodes / seconds : 0.0;
+    bool countOk = expected == 0 || nodes == expected;
+    // divide prints as it goes, which may allocate
+    bool allocationsOk = divide || allocations == 0;
+    bool ok = countOk && allocationsOk;
+
+    printf("%-10s depth %d  %12llu nodes  %8.3fs  %8.2f Mnps  %6llu allocs  %s\n", name, depth,
+        (unsigned long long)nodes, seconds, nps / 1e6, (unsigned long long)allocations,
+        expected == 0 && allocationsOk ? "(unchecked)" : ok ? "ok" : "FAILED");
+    if (!countOk) {
+        printf("%-10s expected %llu\n", name, (unsigned long long)expected);
+    }
+    if (!allocationsOk) {
+        printf("%-10s expected no heap allocations\n", name);
+    }
+    fflush(stdout);
+    return ok;
+}
+
+enum CheckKind { CheckHash, CheckCodec, CheckStages, CheckHistory };
+
+static bool runCheck(const char *name, const std::string &fen, int depth, CheckKind kind)
+{
+    Position position;
+    if (!position.setFEN(fen)) {
+        std::cerr << name << ": bad fen \"" << fen << "\"\n";
+        return false;
+    }
+    uint64_t mismatches = kind == CheckCodec ? perftVerifyCodec(position, depth)
+        : kind == CheckStages ? perftVerifyStages(position, depth)
+        : kind == CheckHistory ? verifyTurnHistory(position, depth * 10)
+        : perftVerifyHash(position, depth);
+    const char *kindNames[] = { "hash", "codec", "stages", "history" };
+    printf("%-10s depth %d  %s %s", name, depth, kindNames[kind], mismatches ? "FAILED" : "ok");
+    if (mismatches) {
+        printf(" (%llu mismatches)", (unsigned long long)mismatches);
+    }
+    printf("\n");
+    fflush(stdout);
+    return mismatches == 0;
+}
+
+// othello or checkers from the start position
+static bool runBoardGame(bool othello, int depth)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = othello ? perftOthello(OthelloBoard(), depth) : perftCheckers(CheckersBoard(), depth);
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double nps = seconds > 0.0 ? nodes / seconds : 0.0;
+    const uint64_t *counts = othello ? kOthelloExpected : kCheckersExpected;
+    int known = othello ? (int)(sizeof(kOthelloExpected) / sizeof(kOthelloExpected[0])) : (int)(sizeof(kCheckersExpected) / sizeof(kCheckersExpected[0]));
+    uint64_t expected = depth < known ? counts[depth] : 0;
+    bool ok = expected == 0 || nodes == expected;
+
+    printf("%-10s depth %d  %12llu nodes  %8.3fs  %8.2f Mnps  %s\n", othello ? "othello" : "checkers", depth,
+        (unsigned long long)nodes, seconds, nps / 1e6,
+        expected == 0 ? "(unchecked)" : ok ? "ok" : "FAILED");
+    fflush(stdout);
+    return ok;
+}
+
+// gomoku, a small board and tic-tac-toe
+static bool runKInARowHistory()
+{
+    const int sizes[][3] = { { 15, 15, 5 }, { 7, 7, 4 }, { 3, 3, 3 } };
+    bool allPassed = true;
+    for (const auto &size : sizes) {
+        uint64_t mismatches = verifyKInARowHistory(size[0], size[1], size[2]);
+        printf("kinarow %dx%d k%d  history %s\n", size[0], size[1], size[2], mismatches ? "FAILED" : "ok");
+        allPassed &= mismatches == 0;
+    }
+    fflush(stdout);
+    return allPassed;
+}
+
+// every ";D<n> <count>" operation on every line, up to maxDepth when it's set
+static bool runEPD(const std::string &path, int maxDepth, bool bulk)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "can't open " << path << "\n";
+        return false;
+    }
+    std::vector<EpdEntry> entries;
+    size_t failures = loadEPD(file, entries);
+    if (failures) {
+        std::cerr << path << ": " << failures << " lines didn't parse\n";
+    }
+
+    bool allPassed = failures == 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        std::string name = "epd " + std::to_string(i + 1);
+        for (const auto &op : entries[i].operations) {
+            if (op.first.size() < 2 || op.first[0] != 'D') {
+                continue;
+            }
+            int depth = atoi(op.first.c_str() + 1);
+            if (depth < 1 || (maxDepth > 0 && depth > maxDepth)) {
+                continue;
+            }
+            allPassed &= runPerft(name.c_str(), entries[i].position.fen(), depth, strtoull(op.second.c_str(), nullptr, 10), bulk, false);
+        }
+    }
+    return allPassed;
+}
+
+int main(int argc, char **argv)
+{
+    std::string suiteName = "all";
+    std::string fen;
+    std::string epd;
+    int depth = 0;
+    bool bulk = true;
+    bool divide = false;
+    bool verifyHash = false;
+    bool verifyCodec = false;
+    bool verifyStages = false;
+    bool verifyHistory = false;
+    bool othello = false;
+    bool checkers = false;
+    bool kinarowHistory = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--suite") && i + 1 < argc) {
+            suiteName = argv[++i];
+        } else if (!strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--fen") && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (!strcmp(argv[i], "--epd") && i + 1 < argc) {
+            epd = argv[++i];
+        } else if (!strcmp(argv[i], "--divide")) {
+            divide = true;
+        } else if (!strcmp(argv[i], "--no-bulk")) {
+            bulk = false;
+        } else if (!strcmp(argv[i], "--verify-hash")) {
+            verifyHash = true;
+        } else if (!strcmp(argv[i], "--verify-codec")) {
+            verifyCodec = true;
+        } else if (!strcmp(argv[i], "--verify-stages")) {
+            verifyStages = true;
+        } else if (!strcmp(argv[i], "--verify-history")) {
+            verifyHistory = true;
+        } else if (!strcmp(argv[i], "--othello")) {
+            othello = true;
+        } else if (!strcmp(argv[i], "--checkers")) {
+            checkers = true;
+        } else if (!strcmp(argv[i], "--kinarow-history")) {
+            kinarowHistory = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (kinarowHistory) {
+        return runKInARowHistory() ? 0 : 1;
+    }
+    if (othello || checkers) {
+        int defaultDepth = othello ? kOthelloDefaultDepth : kCheckersDefaultDepth;
+        return runBoardGame(othello, depth > 0 ? depth : defaultDepth) ? 0 : 1;
+    }
+
+    bool verify = verifyHash || verifyCodec || verifyStages || verifyHistory;
+    CheckKind checkKind = verifyCodec ? CheckCodec : verifyStages ? CheckStages : verifyHistory ? CheckHistory : CheckHash;
+    if (!fen.empty()) {
+        int fenDepth = depth > 0 ? depth : 1;
+        bool ok = verify ? runCheck("fen", fen, fenDepth, checkKind) : runPerft("fen", fen, fenDepth, 0, bulk, divide);
+        return ok ? 0 : 1;
+    }
+    if (!epd.empty()) {
+        return runEPD(epd, depth, bulk) ? 0 : 1;
+    }
+
+    bool allPassed = true;
+    bool found = false;
+    for (const PerftSuite &suite : kSuites) {
+        if (suiteName != "all" && suiteName != suite.name) {
+            continue;
+        }
+        found = true;
+        int suiteDepth = depth > 0 ? depth : suite.defaultDepth;
+        uint64_t expected = suiteDepth < 7 ? suite.expected[suiteDepth] : 0;
+        if (verify) {
+            allPassed &= runCheck(suite.name, suite.fen, depth > 0 ? depth : 3, checkKind);
+        } else {
+            allPassed &= runPerft(suite.name, suite.fen, suiteDepth, expected, bulk, divide);
+        }
+    }
+
+    if (!found) {
+        usage();
+        return 2;
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+// chess-uci: the chess engine behind a universal chess interface front end
+//
+// usage: chess-uci [command ...]
+//
+// with no arguments it speaks UCI on stdin/stdout for a gui or tournament
+// manager. any arguments are run as commands, one per argument, and the
+// process exits when the last search finishes, e.g.
+//     chess-uci "position startpos moves e2e4" "go depth 12"
+//     chess-uci "setoption name Threads value 8" "bench 12"
+
+#include "classes/UciEngine.h"
+
+int main(int argc, char **argv)
+{
+    UciEngine engine(std::cout);
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            if (!engine.command(argv[i])) {
+                return 0;
+            }
+            engine.waitForSearch();
+        }
+        return 0;
+    }
+
+    engine.run(std::cin);
+    return 0;
+}